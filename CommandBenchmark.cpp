@@ -0,0 +1,245 @@
+#include "CommandBenchmark.h"
+#include "PossibilitySet.h"
+#include "Dictionary.h"
+#include "CommandNumWordB.h"
+#include "StepArena.h"
+#include "HeapCounter.h"
+
+namespace
+{
+double SecondsSince(const std::chrono::steady_clock::time_point& startTime)
+{
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    return elapsed.count();
+}
+
+// Same work as the optimal pattern match searches: every test word in the dictionary scored by its largest match set.
+// Returns the sum of those largest set sizes, so different layouts can be checked against each other.
+uint64_t ScoreAllTestWords(const MatchPatternLookup& lookup)
+{
+    uint64_t sumOfLargestSetSizes = 0;
+    for (const NumberWord& testWord : Dictionary::GetDefault().GetAllWords())
+    {
+        uint16_t matchPatterns[kMatchPatternHistogramSize] = { 0 };
+        lookup.AddTestResultsToHistogram(testWord, matchPatterns);
+
+        uint16_t largestSetSize = 0;
+        for (size_t i = 0; i < kMatchPatternHistogramSize; ++i)
+        {
+            if (matchPatterns[i] > largestSetSize)
+            {
+                largestSetSize = matchPatterns[i];
+            }
+        }
+        sumOfLargestSetSizes += largestSetSize;
+    }
+    return sumOfLargestSetSizes;
+}
+} // namespace
+
+void Benchmark::COMMAND_MatchPatternLayouts()
+{
+    printf("Scoring all %zu test words, lookups chosen at %zu+ possibilities are test-major\n\n", Dictionary::GetDefault().GetAllWords().size(), kMinPossibilitiesForTestMajorLookup);
+    printf("   Possibilities |     computed | answer-major | test-major | speedup\n");
+
+    // Evenly spread subsets of the dictionary stand in for mid-game possibility sets, then the two real sources
+    const size_t subsetSizes[] = { 8, 32, 128, 512, 1024, 1536, 2048, 4096 };
+    std::vector<std::vector<NumberWord>> possibilitySets;
+    for (const size_t subsetSize : subsetSizes)
+    {
+        possibilitySets.emplace_back();
+        const size_t stride = kNumWords / subsetSize;
+        for (size_t i = 0; i < subsetSize; ++i)
+        {
+            possibilitySets.back().push_back(Dictionary::GetDefault().GetAllWords().at(i * stride));
+        }
+    }
+    possibilitySets.push_back(Dictionary::GetDefault().GetAnswerWords());
+    possibilitySets.push_back(Dictionary::GetDefault().GetAllWords());
+
+    for (const std::vector<NumberWord>& possibilities : possibilitySets)
+    {
+        const MatchPatternLookup computedLookup(possibilities, MatchPatternLayout::kComputed);
+        const MatchPatternLookup answerMajorLookup(possibilities, MatchPatternLayout::kAnswerMajor);
+        const MatchPatternLookup testMajorLookup(possibilities, MatchPatternLayout::kTestMajor);
+
+        auto startTime = std::chrono::steady_clock::now();
+        const uint64_t computedScore = ScoreAllTestWords(computedLookup);
+        const double computedSeconds = SecondsSince(startTime);
+
+        // Possibilities outside an answers-only matrix fall back to computing, so there's nothing to compare against
+        if (answerMajorLookup.GetLayout() == MatchPatternLayout::kComputed)
+        {
+            printf(" %15zu | %11.4fs | %12s | %10s |\n", possibilities.size(), computedSeconds, "-", "-");
+            continue;
+        }
+
+        startTime = std::chrono::steady_clock::now();
+        const uint64_t answerMajorScore = ScoreAllTestWords(answerMajorLookup);
+        const double answerMajorSeconds = SecondsSince(startTime);
+
+        startTime = std::chrono::steady_clock::now();
+        const uint64_t testMajorScore = ScoreAllTestWords(testMajorLookup);
+        const double testMajorSeconds = SecondsSince(startTime);
+
+        const bool resultsMatch = (computedScore == answerMajorScore) && (answerMajorScore == testMajorScore);
+        printf(" %15zu | %11.4fs | %11.4fs | %9.4fs | %6.2fx%s\n", possibilities.size(), computedSeconds, answerMajorSeconds, testMajorSeconds,
+            answerMajorSeconds / testMajorSeconds, resultsMatch ? "" : "  RESULTS DIFFER!");
+    }
+}
+
+void Benchmark::COMMAND_PossibilityFiltering()
+{
+    // Narrow the whole dictionary down for every answer after the same two guesses, the way the strategies do
+    const NumberWord guesses[] = { NumberWord::LookupNumberWord("trace"), NumberWord::LookupNumberWord("doily") };
+
+    printf("Narrowing all %zu words for each of %zu answers by two guesses\n\n", Dictionary::GetDefault().GetAllWords().size(), Dictionary::GetDefault().GetAnswerWords().size());
+
+    auto startTime = std::chrono::steady_clock::now();
+    uint64_t vectorRemaining = 0;
+    for (const NumberWord& answer : Dictionary::GetDefault().GetAnswerWords())
+    {
+        std::vector<NumberWord> possibilities = Dictionary::GetDefault().GetAllWords();
+        for (const NumberWord& guess : guesses)
+        {
+            const MatchPattern pattern = answer.GetTestResults(guess);
+            std::vector<NumberWord> newPossibilities;
+            for (const NumberWord& possibility : possibilities)
+            {
+                if (possibility.IsValidWith(guess, pattern))
+                {
+                    newPossibilities.push_back(possibility);
+                }
+            }
+            possibilities.swap(newPossibilities);
+        }
+        vectorRemaining += possibilities.size();
+    }
+    const double vectorSeconds = SecondsSince(startTime);
+
+    const PossibilitySet allWordsSet(Dictionary::GetDefault().GetAllWords());
+    double setSeconds[2] = { 0., 0. };
+    uint64_t setRemaining[2] = { 0, 0 };
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        startTime = std::chrono::steady_clock::now();
+        for (const NumberWord& answer : Dictionary::GetDefault().GetAnswerWords())
+        {
+            PossibilitySet possibilities = allWordsSet;
+            for (const NumberWord& guess : guesses)
+            {
+                possibilities.KeepOnlyMatching(guess, answer.GetTestResults(guess));
+            }
+            setRemaining[pass] += possibilities.Count();
+        }
+        setSeconds[pass] = SecondsSince(startTime);
+    }
+
+    startTime = std::chrono::steady_clock::now();
+    uint64_t lookupRemaining = 0;
+    for (const NumberWord& answer : Dictionary::GetDefault().GetAnswerWords())
+    {
+        PossibilitySet possibilities = allWordsSet;
+        for (const NumberWord& guess : guesses)
+        {
+            possibilities.KeepOnlyMatchingByLookup(guess, answer.GetTestResults(guess));
+        }
+        lookupRemaining += possibilities.Count();
+    }
+    const double lookupSeconds = SecondsSince(startTime);
+
+    printf(" IsValidWith on vectors | %9.4fs\n", vectorSeconds);
+    printf(" Masks, first pass      | %9.4fs\n", setSeconds[0]);
+    printf(" Masks, cached          | %9.4fs (%zu masks)\n", setSeconds[1], PossibilitySet::GetNumCachedMasks());
+    printf(" Lookups, no lock       | %9.4fs\n", lookupSeconds);
+    if ((vectorRemaining != setRemaining[0]) || (vectorRemaining != setRemaining[1]) || (vectorRemaining != lookupRemaining))
+    {
+        printf(" RESULTS DIFFER!\n");
+    }
+
+    // Bucket sizes of the answers against the first few hundred test words, as popcounts and as a histogram
+    const size_t numTestWords = std::min<size_t>(256, Dictionary::GetDefault().GetAllWords().size());
+    const PossibilitySet& answerSet = Dictionary::GetDefault().GetSet(WordSubset::kAnswerWords);
+    const MatchPatternLookup lookup(Dictionary::GetDefault().GetAnswerWords());
+    bool bucketsMatch = true;
+    startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < numTestWords; ++i)
+    {
+        const NumberWord& testWord = Dictionary::GetDefault().GetAllWords().at(i);
+        uint16_t bucketSizes[kMatchPatternHistogramSize];
+        answerSet.GetBucketSizes(testWord, bucketSizes);
+        uint16_t matchPatterns[kMatchPatternHistogramSize] = { 0 };
+        lookup.AddTestResultsToHistogram(testWord, matchPatterns);
+        bucketsMatch = bucketsMatch && (memcmp(bucketSizes, matchPatterns, sizeof(matchPatterns)) == 0);
+    }
+    printf("\n Answer bucket sizes from popcounts, %zu test words | %9.4fs%s\n", numTestWords, SecondsSince(startTime), bucketsMatch ? "" : "  RESULTS DIFFER!");
+}
+
+void Benchmark::COMMAND_StepAllocations()
+{
+    // The first pass fills the memo and mask cache, which has to allocate. Once that is done, playing the same
+    // games again, or any game down branches already seen, should not touch the heap at all.
+    if (!HeapCounter::kIsCounting)
+    {
+        printf("Heap allocations are only counted in a build with WORDLESS_COUNT_HEAP_ALLOCATIONS defined\n\n");
+    }
+    printf("Playing all %zu answers with the default strategy, twice\n\n", Dictionary::GetDefault().GetAnswerWords().size());
+    printf(" Pass   | Heap allocations | Per game | Searches | Time\n");
+
+    NumWordB::NumberWordStrategy strategy(Dictionary::GetDefault());
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        const size_t searchesAtStart = strategy.GetNumMemoMisses();
+        const size_t heapAllocationsAtStart = HeapCounter::GetNumHeapAllocations();
+        const auto startTime = std::chrono::steady_clock::now();
+        for (const NumberWord& answer : Dictionary::GetDefault().GetAnswerWords())
+        {
+            strategy.TestSpecificWord(answer);
+        }
+        const double seconds = SecondsSince(startTime);
+        const size_t heapAllocations = HeapCounter::GetNumHeapAllocations() - heapAllocationsAtStart;
+        printf(" %-6s | %16zu | %8.2f | %8zu | %.4fs\n", (pass == 0) ? "first" : "repeat", heapAllocations,
+            static_cast<double>(heapAllocations) / static_cast<double>(Dictionary::GetDefault().GetAnswerWords().size()), strategy.GetNumMemoMisses() - searchesAtStart, seconds);
+    }
+
+    // Every target at once through the partitioning solver, with a fresh memo so every step is searched again
+    NumWordB::NumberWordStrategy solver(Dictionary::GetDefault());
+    const size_t heapAllocationsAtStart = HeapCounter::GetNumHeapAllocations();
+    solver.TestAllPossibilities(Dictionary::GetDefault().GetAnswerWords());
+    const size_t heapAllocations = HeapCounter::GetNumHeapAllocations() - heapAllocationsAtStart;
+    printf("\n All answers partitioned at once: %zu heap allocations for %zu searches (%zu memo entries)\n", heapAllocations, solver.GetNumMemoMisses(), solver.GetNumMemoEntries());
+}
+
+void Benchmark::COMMAND_ScoringStrategies()
+{
+    // Each scoring rule makes every searched guess after the opener, with a fresh memo so each decision is searched
+    // once. Decisions are counted as searches, which is what the time per decision is over.
+    typedef NumWordB::NumberWordStrategy::StepStrategy StepStrategy;
+    const struct
+    {
+        const char* mName;
+        StepStrategy mStrategy;
+    } scoringRules[] = {
+        { "largest match set", StepStrategy::kOptimalPatternMatch },
+        { "max entropy", StepStrategy::kMaxEntropy },
+        { "min expected size", StepStrategy::kMinExpectedSize },
+    };
+
+    printf("Solving all %zu answers, each scoring rule used for steps 2 to %zu\n\n", Dictionary::GetDefault().GetAnswerWords().size(), NumWordB::kMaxSteps - 1);
+    printf(" Scoring rule      | Avg steps | Fails | Decisions | Time      | Per decision | Pruned\n");
+    for (const auto& scoringRule : scoringRules)
+    {
+        NumWordB::NumberWordStrategy strategy(Dictionary::GetDefault());
+        for (size_t step = 2; step < NumWordB::kMaxSteps; ++step)
+        {
+            strategy.SetSpecificStepStrategy(step, scoringRule.mStrategy);
+        }
+
+        const auto startTime = std::chrono::steady_clock::now();
+        const uint32_t fails = strategy.TestAllPossibilities(Dictionary::GetDefault().GetAnswerWords());
+        const double seconds = SecondsSince(startTime);
+        const size_t decisions = strategy.GetNumMemoMisses();
+        printf(" %-17s | %9.4f | %5u | %9zu | %8.4fs | %10.4fms | %5.1f%%\n", scoringRule.mName, strategy.GetAverageStepsToSolve(), fails, decisions, seconds,
+            (decisions != 0) ? (seconds * 1000.) / static_cast<double>(decisions) : 0., strategy.GetPruningRatio() * 100.);
+    }
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+
+namespace Benchmark
+{
+// COMMANDS
+void COMMAND_MatchPatternLayouts();
+void COMMAND_PossibilityFiltering();
+void COMMAND_StepAllocations();
+void COMMAND_ScoringStrategies();
+} // namespace Benchmark
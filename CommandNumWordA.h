@@ -1,32 +1,26 @@
 #pragma once
 #include "stdafx.h"
 #include "NumWords.h"
+#include "Dictionary.h"
+#include "SweepExecutor.h"
+#include "HeapCounter.h"
 
 namespace NumWordA
 {
-NumberWord FindOptimalNumWordViaMatchingPatterns(const std::vector<NumberWord>& remainingPossibilities)
+NumberWord FindOptimalNumWordViaMatchingPatterns(const MatchPatternLookup& lookup)
 {
-    if (remainingPossibilities.size() < 3)
-    {
-        return remainingPossibilities.at(0);
-    }
-
     // What testWord, when applied, would result in a set of match patterns with the least entries in its largest sized match
 
     uint16_t currentLowestLargeSetSize = UINT16_MAX;
     NumberWord currentLowestLargeSetWord = kInvalidNumberWord;
 
-    for (const NumberWord& testWord : NumberWord::sAllWords)
+    for (const NumberWord& testWord : Dictionary::GetDefault().GetAllWords())
     {
-        uint16_t matchPatterns[1024] = { 0 };
-        for (const NumberWord& possibility : remainingPossibilities)
-        {
-            const uint16_t pattern = possibility.GetTestResults(testWord) - kEarmarkMatchPattern;
-            matchPatterns[pattern] += 1;
-        }
+        uint16_t matchPatterns[kMatchPatternHistogramSize] = { 0 };
+        lookup.AddTestResultsToHistogram(testWord, matchPatterns);
 
         uint16_t largestSetSize = 0;
-        for (size_t i = 0; i < 1024; ++i)
+        for (size_t i = 0; i < kMatchPatternHistogramSize; ++i)
         {
             if (matchPatterns[i] > largestSetSize)
             {
@@ -44,22 +38,49 @@ NumberWord FindOptimalNumWordViaMatchingPatterns(const std::vector<NumberWord>&
     return currentLowestLargeSetWord;
 }
 
-void PairDownSetForWordFromEntryWord(uint16_t sourceMatch, const NumberWord& entryWord, const std::vector<NumberWord>& sourcePossibilities, std::vector<NumberWord>& outNewPossibilities)
+NumberWord FindOptimalNumWordViaMatchingPatterns(const std::vector<NumberWord>& remainingPossibilities)
 {
-    for (const NumberWord& possibility : sourcePossibilities)
+    if (remainingPossibilities.size() < 3)
     {
-        if (possibility.IsValidWith(entryWord, sourceMatch))
+        return remainingPossibilities.at(0);
+    }
+    return FindOptimalNumWordViaMatchingPatterns(MatchPatternLookup(remainingPossibilities));
+}
+
+// possibilities are kWordList indices, lookup is the arena's and gets rebuilt for them
+NumberWord FindOptimalNumWordViaMatchingPatterns(const uint16_t* const possibilities, const size_t numPossibilities, MatchPatternLookup& lookup)
+{
+    if (numPossibilities < 3)
+    {
+        return NumberWord::GetDictionaryWord(possibilities[0]);
+    }
+    lookup.Assign(possibilities, numPossibilities);
+    return FindOptimalNumWordViaMatchingPatterns(lookup);
+}
+
+// The step policy every NumWordA sweep plays by
+struct OptimalMatchPatternPolicy
+{
+    uint32_t mMaxSteps = kMaxSweepSteps;
+
+    uint32_t GetMaxSteps() const { return mMaxSteps; }
+
+    NumberWord GetGuess(const uint32_t steps, const uint16_t* const possibilities, const size_t numPossibilities, MatchPatternLookup& lookup) const
+    {
+        // Last step, we can't get any more info. Don't pair down and instead just choose one
+        if (steps == 5)
         {
-            outNewPossibilities.emplace_back(possibility);
+            return NumberWord::GetDictionaryWord(possibilities[0]);
         }
+        return FindOptimalNumWordViaMatchingPatterns(possibilities, numPossibilities, lookup);
     }
-}
+};
 
-void PrintWordAndPossibilities(const NumberWord& word, const uint16_t results, const std::vector<NumberWord>& possibilities, const uint32_t maxLines, const uint32_t wordsPerLine)
+void PrintWordAndPossibilities(const NumberWord& word, const MatchPattern results, const uint16_t* const possibilities, const size_t numPossibilities, const uint32_t maxLines, const uint32_t wordsPerLine)
 {
     std::string textForWord;
     word.ConvertToString(textForWord);
-    printf("\n%s %hu: ", textForWord.c_str(), results);
+    printf("\n%s %hu: ", textForWord.c_str(), ConvertToLegacyMatchPattern(results));
 
     size_t index = 0;
 
@@ -67,18 +88,18 @@ void PrintWordAndPossibilities(const NumberWord& word, const uint16_t results, c
     {
         for (size_t word = 0; word < wordsPerLine; ++word)
         {
-            if (index >= possibilities.size())
+            if (index >= numPossibilities)
             {
                 break;
             }
 
-            possibilities[index].ConvertToString(textForWord);
+            NumberWord::GetDictionaryWord(possibilities[index]).ConvertToString(textForWord);
             printf("%s, ", textForWord.c_str());
 
             ++index;
         }
 
-        if ((index >= possibilities.size()) || ((line + 1) == maxLines))
+        if ((index >= numPossibilities) || ((line + 1) == maxLines))
         {
             break;
         }
@@ -86,7 +107,7 @@ void PrintWordAndPossibilities(const NumberWord& word, const uint16_t results, c
         printf("...\n        ");
     }
 
-    if (possibilities.size() > index)
+    if (numPossibilities > index)
     {
         printf("...");
     }
@@ -95,7 +116,7 @@ void PrintWordAndPossibilities(const NumberWord& word, const uint16_t results, c
 
 void COMMAND_OptimalFirstNumWord()
 {
-    NumberWord optimalWord = FindOptimalNumWordViaMatchingPatterns(NumberWord::sAllWords);
+    NumberWord optimalWord = FindOptimalNumWordViaMatchingPatterns(Dictionary::GetDefault().GetAllWords());
     std::string textForWord;
     optimalWord.ConvertToString(textForWord);
     printf("\n\n%s\n", textForWord.c_str());
@@ -103,56 +124,29 @@ void COMMAND_OptimalFirstNumWord()
 
 void TestSpecificWord(const NumberWord& targetWord)
 {
-    std::string textForWord;
-
     const NumberWord firstPairing(kSupposedMostOptimizedFirstWord);
 
     printf("\n\n");
 
-    std::vector<NumberWord>* possibilities = new std::vector<NumberWord>();
-    NumberWord optimalWord(kInvalidNumberWord);
-
-    // First Step
+    StepArena arena;
+    auto printStep = [](uint32_t steps, const NumberWord& guess, MatchPattern results, const uint16_t* possibilities, size_t numPossibilities)
     {
-        const uint16_t results = targetWord.GetTestResults(firstPairing);
-        PairDownSetForWordFromEntryWord(results,
-            firstPairing, NumberWord::sAllWords, *possibilities);
-        PrintWordAndPossibilities(firstPairing, results, *possibilities, 4, 18);
-        optimalWord = FindOptimalNumWordViaMatchingPatterns(*possibilities);
-    }
-
-    for (size_t i = 0; i < 12; ++i)
-    {
-        std::vector<NumberWord>* newPossibilities = new std::vector<NumberWord>();
-        const uint16_t results = targetWord.GetTestResults(optimalWord);
-        PairDownSetForWordFromEntryWord(results,
-            optimalWord, *possibilities, *newPossibilities);
-        PrintWordAndPossibilities(optimalWord, results, *newPossibilities, 4, 18);
-
-        if (i == 3)
-        {
-            optimalWord = newPossibilities->at(0);
-        }
-        else
-        {
-            optimalWord = FindOptimalNumWordViaMatchingPatterns(*newPossibilities);
-        }
-
-        delete possibilities;
-        possibilities = newPossibilities;
-
-        if (i == 4)
+        PrintWordAndPossibilities(guess, results, possibilities, numPossibilities, 4, 18);
+        if (steps == 5)
         {
             printf("====END====\n");
         }
-        if (optimalWord == targetWord)
-        {
-            optimalWord.ConvertToString(textForWord);
-            printf("%s", textForWord.c_str());
-            break;
-        }
+    };
+    PatternPartition firstPartition;
+    firstPartition.Assign(firstPairing, Dictionary::GetDefault().GetAllWords(), arena.GetStep(0));
+    const SweepGame game = PlaySweepGame(firstPartition, targetWord, OptimalMatchPatternPolicy(), arena, printStep);
+
+    if (game.mSteps < kMaxSweepSteps)
+    {
+        std::string textForWord;
+        targetWord.ConvertToString(textForWord);
+        printf("%s", textForWord.c_str());
     }
-    delete possibilities;
 }
 
 void COMMAND_SpecificWord(const char* const word)
@@ -187,90 +181,60 @@ void COMMAND_ZillsTest()
 
 void COMMAND_SmallDictSize()
 {
-    NumberWord::SwapToSmallSetOfWords();
+    Dictionary::GetDefault().UseSmallSetOfWords(true);
 }
 
 void COMMAND_FullDictSize()
 {
-    NumberWord::SwapToAllWords();
+    Dictionary::GetDefault().UseSmallSetOfWords(false);
 }
 
-void COMMAND_ComprehensiveTest()
+// Plays every target from the supposed most optimized first word, listing the targets taking more than
+// listLosingWordsOverSteps steps
+void ComprehensiveTest(const std::vector<NumberWord>& targetWords, const uint32_t listLosingWordsOverSteps)
 {
-    std::string textForWord;
-    const NumberWord firstPairing(kSupposedMostOptimizedFirstWord);
-
-    std::map<uint32_t, uint32_t> stepsToWinningWords;
-    std::map<uint32_t, std::vector<NumberWord>> stepsToLosingWords;
-
-    for (const NumberWord& targetWord : NumberWord::sAllWords)
+    struct ComprehensiveSink
     {
-        targetWord.ConvertToString(textForWord);
-        printf("%s,  ", textForWord.c_str());
-
-        std::vector<NumberWord>* possibilities = new std::vector<NumberWord>();
-        NumberWord optimalWord(kInvalidNumberWord);
-
-        uint32_t steps = 0;
+        const std::vector<NumberWord>& mTargetWords;
+        uint32_t mListLosingWordsOverSteps;
+        std::map<uint32_t, uint32_t> mStepsToWinningWords;
+        std::map<uint32_t, std::vector<NumberWord>> mStepsToLosingWords;
+        std::string mTextForWord;
 
-        if (targetWord != firstPairing)
+        bool OnGame(size_t, size_t targetIndex, const SweepGame& game)
         {
-            PairDownSetForWordFromEntryWord(targetWord.GetTestResults(firstPairing),
-                firstPairing, NumberWord::sAllWords, *possibilities);
-            ++steps;
+            const NumberWord& targetWord = mTargetWords[targetIndex];
+            targetWord.ConvertToString(mTextForWord);
+            printf("%s,  ", mTextForWord.c_str());
 
-            for (; steps < 12; ++steps)
+            ++mStepsToWinningWords[game.mSteps];
+            if (game.mSteps > mListLosingWordsOverSteps)
             {
-                // Last step, we can't get any more info. Don't pair down and instead just choose one
-                if (steps == 5)
-                {
-                    optimalWord = possibilities->at(0);
-                }
-                else
-                {
-                    optimalWord = FindOptimalNumWordViaMatchingPatterns(*possibilities);
-                }
-
-                if (optimalWord == targetWord)
-                {
-                    break;
-                }
-
-                std::vector<NumberWord>* newPossibilities = new std::vector<NumberWord>();
-                PairDownSetForWordFromEntryWord(targetWord.GetTestResults(optimalWord),
-                    optimalWord, *possibilities, *newPossibilities);
-
-                delete possibilities;
-                possibilities = newPossibilities;
+                mStepsToLosingWords[game.mSteps].push_back(targetWord);
             }
+            return true;
         }
-        delete possibilities;
 
-        std::map<uint32_t, uint32_t>::iterator it = stepsToWinningWords.find(steps);
-        if (it == stepsToWinningWords.end())
-        {
-            stepsToWinningWords[steps] = 1;
-        }
-        else
-        {
-            stepsToWinningWords[steps] = (*it).second + 1;
-        }
+        void OnSourceDone(size_t) {}
+    };
 
-        if (steps > 4)
-        {
-            stepsToLosingWords[steps].push_back(targetWord);
-        }
-    }
+    const std::vector<NumberWord> firstPairing(1, NumberWord(kSupposedMostOptimizedFirstWord));
+    ComprehensiveSink sink = { targetWords, listLosingWordsOverSteps };
 
+    const size_t heapAllocationsAtStart = HeapCounter::GetNumHeapAllocations();
+    RunSweep(firstPairing, Dictionary::GetDefault().GetAllWords(), targetWords, OptimalMatchPatternPolicy(), sink);
+    const size_t heapAllocationsDuringTest = HeapCounter::GetNumHeapAllocations() - heapAllocationsAtStart;
+
+    std::string textForWord;
     printf("\n\n===Wins===");
-    for (auto& pair : stepsToWinningWords)
+    for (auto& pair : sink.mStepsToWinningWords)
     {
         printf("\n Steps %u --- Wins: %u", pair.first + 1u, pair.second);
-        if (pair.first > 4)
+        if (pair.first > listLosingWordsOverSteps)
         {
             uint32_t perLine = 0;
             printf(" : ");
-            for (const NumberWord& losingNumber : stepsToLosingWords[pair.first])
+            for (const NumberWord& losingNumber : sink.mStepsToLosingWords[pair.first])
             {
                 losingNumber.ConvertToString(textForWord);
                 printf("%s, ", textForWord.c_str());
@@ -283,97 +247,102 @@ void COMMAND_ComprehensiveTest()
             }
         }
     }
+    if (HeapCounter::kIsCounting)
+    {
+        printf("\n\nHeap allocations during the test: %zu", heapAllocationsDuringTest);
+    }
 }
 
+void COMMAND_ComprehensiveTest()
+{
+    ComprehensiveTest(Dictionary::GetDefault().GetAllWords(), 4);
+}
 
 void FindOptimalFirstWord(const std::vector<NumberWord>& firstPairings, const std::vector<NumberWord>& evaluateThroughWords, uint32_t incrementVisualEveryNWords)
 {
-    std::string textForWord;
-
-    uint32_t lowestTotalFailed = UINT32_MAX;
-    std::vector<NumberWord> lowestFailedWords;
-
-    for (const NumberWord& firstPairing : firstPairings)
+    // All first pairings share the lowest total fails found so far. One stops as soon as it passes that, which can't
+    // change the outcome: it has lost either way, and a tie never passes it.
+    struct PairingResult
     {
-        firstPairing.ConvertToString(textForWord);
-        printf("\n%s : ", textForWord.c_str());
-
-        uint32_t visualIncrementControls = 0;
-        uint32_t totalFailed = 0;
+        uint32_t mTotalFailed = 0;
+        uint32_t mVisualIncrementControls = 0;
+        uint32_t mNumVisualIncrements = 0;
+    };
 
-        //
-        for (const NumberWord& targetWord : evaluateThroughWords)
+    struct FirstWordSink
+    {
+        const std::vector<NumberWord>& mFirstPairings;
+        size_t mNumTargets;
+        uint32_t mIncrementVisualEveryNWords;
+        std::vector<PairingResult> mResults;
+        std::atomic<uint32_t> mLowestTotalFailed;
+        std::string mTextForWord;
+
+        FirstWordSink(const std::vector<NumberWord>& firstPairings, const size_t numTargets, const uint32_t incrementVisualEveryNWords)
+            : mFirstPairings(firstPairings)
+            , mNumTargets(numTargets)
+            , mIncrementVisualEveryNWords(incrementVisualEveryNWords)
+            , mResults(firstPairings.size())
+            , mLowestTotalFailed(UINT32_MAX)
         {
-            std::vector<NumberWord>* possibilities = new std::vector<NumberWord>();
-            NumberWord optimalWord(kInvalidNumberWord);
-
-            uint32_t steps = 0;
+        }
 
-            if (targetWord != firstPairing)
+        bool OnGame(size_t pairing, size_t targetIndex, const SweepGame& game)
+        {
+            PairingResult& result = mResults[pairing];
+            if (game.mSteps > 5)
             {
-                PairDownSetForWordFromEntryWord(targetWord.GetTestResults(firstPairing),
-                    firstPairing, NumberWord::sAllWords, *possibilities);
-                ++steps;
-
-                for (; steps < 12; ++steps)
+                ++result.mTotalFailed;
+                if (result.mTotalFailed > mLowestTotalFailed.load(std::memory_order_relaxed))
                 {
-                    // Last step, we can't get any more info. Don't pair down and instead just choose one
-                    if (steps == 5)
-                    {
-                        optimalWord = possibilities->at(0);
-                    }
-                    else
-                    {
-                        optimalWord = FindOptimalNumWordViaMatchingPatterns(*possibilities);
-                    }
-
-                    if (optimalWord == targetWord)
-                    {
-                        break;
-                    }
-
-                    std::vector<NumberWord>* newPossibilities = new std::vector<NumberWord>();
-                    PairDownSetForWordFromEntryWord(targetWord.GetTestResults(optimalWord),
-                        optimalWord, *possibilities, *newPossibilities);
-
-                    delete possibilities;
-                    possibilities = newPossibilities;
+                    return false;
                 }
             }
-            delete possibilities;
 
-            if (steps > 5)
+            ++result.mVisualIncrementControls;
+            if (result.mVisualIncrementControls > mIncrementVisualEveryNWords)
             {
-                ++totalFailed;
-                if (totalFailed > lowestTotalFailed)
+                result.mVisualIncrementControls = 0;
+                ++result.mNumVisualIncrements;
+            }
+
+            // Made it through every target without passing the bound
+            if ((targetIndex + 1) == mNumTargets)
+            {
+                uint32_t lowestTotalFailed = mLowestTotalFailed.load();
+                while ((result.mTotalFailed < lowestTotalFailed) && !mLowestTotalFailed.compare_exchange_weak(lowestTotalFailed, result.mTotalFailed))
                 {
-                    break;
                 }
             }
+            return true;
+        }
 
-            ++visualIncrementControls;
-            if (visualIncrementControls > incrementVisualEveryNWords)
+        void OnSourceDone(size_t pairing)
+        {
+            mFirstPairings[pairing].ConvertToString(mTextForWord);
+            printf("\n%s : ", mTextForWord.c_str());
+            for (uint32_t i = 0; i < mResults[pairing].mNumVisualIncrements; ++i)
             {
-                visualIncrementControls = 0;
                 putchar((char)178);
             }
+            printf(" - FAILED: %u", mResults[pairing].mTotalFailed);
         }
-        //
+    };
 
-        printf(" - FAILED: %u", totalFailed);
+    FirstWordSink sink(firstPairings, evaluateThroughWords.size(), incrementVisualEveryNWords);
+    RunSweep(firstPairings, Dictionary::GetDefault().GetAllWords(), evaluateThroughWords, OptimalMatchPatternPolicy(), sink);
 
-        if (totalFailed < lowestTotalFailed)
-        {
-            lowestTotalFailed = totalFailed;
-            lowestFailedWords.clear();
-            lowestFailedWords.emplace_back(firstPairing);
-        }
-        else if (totalFailed == lowestTotalFailed)
+    const uint32_t lowestTotalFailed = sink.mLowestTotalFailed.load();
+    std::vector<NumberWord> lowestFailedWords;
+    for (size_t pairing = 0; pairing < firstPairings.size(); ++pairing)
+    {
+        if (sink.mResults[pairing].mTotalFailed == lowestTotalFailed)
         {
-            lowestFailedWords.emplace_back(firstPairing);
+            lowestFailedWords.emplace_back(firstPairings[pairing]);
         }
     }
 
+    std::string textForWord;
     printf("\n\n With %u fails, the lowest failing starting words:\n", lowestTotalFailed);
     for (const NumberWord& word : lowestFailedWords)
     {
@@ -384,17 +353,17 @@ void FindOptimalFirstWord(const std::vector<NumberWord>& firstPairings, const st
 
 void COMMAND_FindOptimalFirstWord()
 {
-    FindOptimalFirstWord(NumberWord::sAllWords, NumberWord::sAllWords, 92);
+    FindOptimalFirstWord(Dictionary::GetDefault().GetAllWords(), Dictionary::GetDefault().GetAllWords(), 92);
 }
 
 void COMMAND_FindOptimalFirstWordFromDifficultWordsOnly()
 {
-    FindOptimalFirstWord(NumberWord::sAllWords, NumberWord::sDifficultToEvalWords, 5);
+    FindOptimalFirstWord(Dictionary::GetDefault().GetAllWords(), Dictionary::GetDefault().GetDifficultToEvalWords(), 5);
 }
 
 void COMMAND_FindOptimalFirstWordFromVERYDifficultWordsOnly()
 {
-    FindOptimalFirstWord(NumberWord::sAllWords, NumberWord::sVERYDifficultToEvalWords, 0);
+    FindOptimalFirstWord(Dictionary::GetDefault().GetAllWords(), Dictionary::GetDefault().GetVERYDifficultToEvalWords(), 0);
 }
 
 void COMMAND_FindOptimalFirstWordLimitedFilter()
@@ -408,43 +377,49 @@ void COMMAND_FindOptimalFirstWordLimitedFilter()
         limitedStarts.push_back(NumberWord::LookupNumberWord(charStarts[i]));
     }
 
-    FindOptimalFirstWord(limitedStarts, NumberWord::sDifficultToEvalWords, 5);
+    FindOptimalFirstWord(limitedStarts, Dictionary::GetDefault().GetDifficultToEvalWords(), 5);
 }
 
 void COMMAND_FindAllWordsWithSpecificSecondWord(const char* const secondWordText)
 {
-    std::string textForWord;
-    const NumberWord firstPairing(kSupposedMostOptimizedFirstWord);
-    const NumberWord secondWord = NumberWord::LookupNumberWord(secondWordText);
-
-    for (const NumberWord& targetWord : NumberWord::sAllWords)
+    struct SecondWordSink
     {
-        if (targetWord != firstPairing)
+        const NumberWord mSecondWord;
+        std::string mTextForWord;
+
+        bool OnGame(size_t, size_t targetIndex, const SweepGame& game)
         {
-            std::vector<NumberWord> possibilities;
-            PairDownSetForWordFromEntryWord(targetWord.GetTestResults(firstPairing),
-                firstPairing, NumberWord::sAllWords, possibilities);
-            const NumberWord optimalWord = FindOptimalNumWordViaMatchingPatterns(possibilities);
-            if (optimalWord == secondWord)
+            if ((game.mNumGuesses > 1) && (game.mGuessIndices[1] == mSecondWord.mIndex))
             {
-                targetWord.ConvertToString(textForWord);
-                printf("%s, ", textForWord.c_str());
+                Dictionary::GetDefault().GetAllWords()[targetIndex].ConvertToString(mTextForWord);
+                printf("%s, ", mTextForWord.c_str());
             }
+            return true;
         }
-    }
+
+        void OnSourceDone(size_t) {}
+    };
+
+    // Only the second guess matters, the games stop right after it
+    OptimalMatchPatternPolicy policy;
+    policy.mMaxSteps = 2;
+
+    const std::vector<NumberWord> firstPairing(1, NumberWord(kSupposedMostOptimizedFirstWord));
+    SecondWordSink sink = { NumberWord::LookupNumberWord(secondWordText) };
+    RunSweep(firstPairing, Dictionary::GetDefault().GetAllWords(), Dictionary::GetDefault().GetAllWords(), policy, sink);
 }
 
 void COMMAND_FindAllWordsWithSpecificSecondPattern(uint64_t patternLong)
 {
     std::string textForWord;
     const NumberWord firstPairing(kSupposedMostOptimizedFirstWord);
-    const uint16_t targetPattern = (uint16_t)patternLong;
+    const MatchPattern targetPattern = ConvertFromLegacyMatchPattern((uint16_t)patternLong);
 
-    for (const NumberWord& targetWord : NumberWord::sAllWords)
+    for (const NumberWord& targetWord : Dictionary::GetDefault().GetAllWords())
     {
         if (targetWord != firstPairing)
         {
-            const uint16_t secondPattern = targetWord.GetTestResults(firstPairing);
+            const MatchPattern secondPattern = targetWord.GetTestResults(firstPairing);
 
             if (targetPattern == secondPattern)
             {
@@ -457,92 +432,7 @@ void COMMAND_FindAllWordsWithSpecificSecondPattern(uint64_t patternLong)
 
 void COMMAND_ComprehensiveLimitedTo2049Test()
 {
-    std::string textForWord;
-    const NumberWord firstPairing(kSupposedMostOptimizedFirstWord);
-
-    std::map<uint32_t, uint32_t> stepsToWinningWords;
-    std::map<uint32_t, std::vector<NumberWord>> stepsToLosingWords;
-
-    for (const NumberWord& targetWord : NumberWord::s2049MatchedWords)
-    {
-        targetWord.ConvertToString(textForWord);
-        printf("%s,  ", textForWord.c_str());
-
-        std::vector<NumberWord>* possibilities = new std::vector<NumberWord>();
-        NumberWord optimalWord(kInvalidNumberWord);
-
-        uint32_t steps = 0;
-
-        if (targetWord != firstPairing)
-        {
-            PairDownSetForWordFromEntryWord(targetWord.GetTestResults(firstPairing),
-                firstPairing, NumberWord::sAllWords, *possibilities);
-            ++steps;
-
-            for (; steps < 12; ++steps)
-            {
-                // Last step, we can't get any more info. Don't pair down and instead just choose one
-                if (steps == 5)
-                {
-                    optimalWord = possibilities->at(0);
-                }
-                else
-                {
-                    optimalWord = FindOptimalNumWordViaMatchingPatterns(*possibilities);
-                }
-
-                if (optimalWord == targetWord)
-                {
-                    break;
-                }
-
-                std::vector<NumberWord>* newPossibilities = new std::vector<NumberWord>();
-                PairDownSetForWordFromEntryWord(targetWord.GetTestResults(optimalWord),
-                    optimalWord, *possibilities, *newPossibilities);
-
-                delete possibilities;
-                possibilities = newPossibilities;
-            }
-        }
-        delete possibilities;
-
-        std::map<uint32_t, uint32_t>::iterator it = stepsToWinningWords.find(steps);
-        if (it == stepsToWinningWords.end())
-        {
-            stepsToWinningWords[steps] = 1;
-        }
-        else
-        {
-            stepsToWinningWords[steps] = (*it).second + 1;
-        }
-
-        if (steps > 3)
-        {
-            stepsToLosingWords[steps].push_back(targetWord);
-        }
-    }
-
-    printf("\n\n===Wins===");
-    for (auto& pair : stepsToWinningWords)
-    {
-        printf("\n Steps %u --- Wins: %u", pair.first + 1u, pair.second);
-        if (pair.first > 3)
-        {
-            uint32_t perLine = 0;
-            printf(" : ");
-            for (const NumberWord& losingNumber : stepsToLosingWords[pair.first])
-            {
-                losingNumber.ConvertToString(textForWord);
-                printf("%s, ", textForWord.c_str());
-                ++perLine;
-                if (perLine > 16)
-                {
-                    perLine = 0;
-                    printf("\n          ");
-                }
-            }
-        }
-    }
+    ComprehensiveTest(Dictionary::GetDefault().Get2049MatchedWords(), 3);
 }
 
 }// namespace NumWordA
\ No newline at end of file
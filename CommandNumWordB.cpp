@@ -1,27 +1,95 @@
 #include "CommandNumWordB.h"
 #include "ConsoleInfo.h"
+#include "ThreadPool.h"
+#include "OpenerSweep.h"
+#include "ExactSolver.h"
+#include "GuessSpeculator.h"
+#include "Dictionary.h"
 
-NumWordB::NumberWordStrategy::NumberWordStrategy()
+namespace
+{
+// n*log2(n) with 12 fraction bits, for every size a match set can have. Even the whole dictionary in one set stays well
+// inside 32 bits, and so does the sum over any histogram, since the sum is largest when everything is in one set.
+const uint32_t kNLog2NFractionBits = 12;
+
+const std::vector<uint32_t>& GetNLog2NTable()
+{
+    static const std::vector<uint32_t> sNLog2N = []()
+    {
+        std::vector<uint32_t> table(kNumWords + 1, 0);
+        for (size_t n = 2; n <= kNumWords; ++n)
+        {
+            const double nLog2N = static_cast<double>(n) * log2(static_cast<double>(n));
+            table[n] = static_cast<uint32_t>(llround(nLog2N * static_cast<double>(1u << kNLog2NFractionBits)));
+        }
+        return table;
+    }();
+    return sNLog2N;
+}
+
+// One pass over the histogram, doing only what the metric needs
+template <NumWordB::ScoreMetric kMetric>
+uint64_t ScoreHistogram(const uint16_t* const histogram, const uint32_t* const nLog2N)
+{
+    static_assert((kMetric == NumWordB::ScoreMetric::kLargestMatchSet) || (kMetric == NumWordB::ScoreMetric::kSumOfNLog2N)
+        || (kMetric == NumWordB::ScoreMetric::kSumOfSquares), "Not a histogram metric");
+
+    uint64_t score = 0;
+    for (size_t pattern = 0; pattern < kNumMatchPatterns; ++pattern)
+    {
+        const uint32_t setSize = histogram[pattern];
+        if constexpr (kMetric == NumWordB::ScoreMetric::kLargestMatchSet)
+        {
+            score = std::max<uint64_t>(score, setSize);
+        }
+        else if constexpr (kMetric == NumWordB::ScoreMetric::kSumOfNLog2N)
+        {
+            score += nLog2N[setSize];
+        }
+        else
+        {
+            score += setSize * setSize;
+        }
+    }
+    return score;
+}
+} // namespace
+
+NumWordB::NumberWordStrategy::NumberWordStrategy(const Dictionary& dictionary)
+    : mContext(std::make_shared<const SolverContext>(SolverConfiguration(), dictionary.GetAllWords(), dictionary))
+{
+}
+
+NumWordB::NumberWordStrategy::NumberWordStrategy(std::shared_ptr<const SolverContext> context)
+    : mContext(std::move(context))
 {
-    memcpy(mStepStrategies, kDefaultStrategies, sizeof(kDefaultStrategies));
-    mRemainingPossibilitiesSource = &NumberWord::sAllWords;
-    mSpecialWord1 = NumberWord::LookupNumberWord("stowp");
-    mSpecialWord2 = NumberWord::LookupNumberWord("trace");
 }
 
 size_t NumWordB::NumberWordStrategy::TestSpecificWord(const NumberWord& targetWord)
 {
     NumberWord optimalWord(kInvalidNumberWord);
 
-    mRemainingPossibilities = *mRemainingPossibilitiesSource;
-    mCurrentStep = mStartingStep;
+    ResetRemainingPossibilities();
+    mCurrentStep = mContext->GetConfiguration().mStartingStep;
 
+    // The set is narrowed every step, but the vector is only rebuilt from it when a search actually needs it
+    bool isRemainingVectorCurrent = true;
     bool continueToNextStep = true;
     do
     {
-        const StepStrategy currentStrategy = (mCurrentStep < kMaxSteps) ? mStepStrategies[mCurrentStep] : kStrategyPostMax;
+        const StepStrategy currentStrategy = mContext->GetConfiguration().GetStepStrategy(mCurrentStep);
         ++mCurrentStep;
-        optimalWord = GetOptimalWordFromStrategy(currentStrategy);
+        if (!FindMemoizedWord(currentStrategy, optimalWord))
+        {
+            if (!isRemainingVectorCurrent)
+            {
+                RestoreRemainingPossibilitiesFromSet();
+                isRemainingVectorCurrent = true;
+            }
+            optimalWord = GetOptimalWordFromStrategy(currentStrategy);
+            StoreMemoizedWord(currentStrategy, optimalWord);
+        }
+
         if (optimalWord == targetWord)
         {
             continueToNextStep = false;
@@ -32,14 +100,14 @@ size_t NumWordB::NumberWordStrategy::TestSpecificWord(const NumberWord& targetWo
         }
         else
         {
-            const uint16_t results = targetWord.GetTestResults(optimalWord);
-            if (mCurrentStep < kMaxSteps)
-            {
-                mStepResults[mCurrentStep - 1] = results;
-            }
-            PairDownRemainingPossibilities(results, optimalWord);
+            const MatchPattern results = targetWord.GetTestResults(optimalWord);
+            PairDownRemainingPossibilitySet(results, optimalWord);
+            mGuessHistory.push_back((static_cast<uint32_t>(optimalWord.mIndex) << 8) | results);
+            isRemainingVectorCurrent = false;
             if (HasPrintBehavior(PrintBehavior::kOptimalWordsAndRemainingPossibilities))
             {
+                RestoreRemainingPossibilitiesFromSet();
+                isRemainingVectorCurrent = true;
                 PrintWord(mCurrentStep, optimalWord, results);
                 PrintPossibilities();
             }
@@ -56,7 +124,13 @@ uint32_t NumWordB::NumberWordStrategy::TestAllPossibilities(const std::vector<Nu
 
 uint32_t NumWordB::NumberWordStrategy::TestAllPossibilitiesUntilPassXFails(const std::vector<NumberWord>& allPossibilities, uint32_t xFails)
 {
-    mRemainingPossibilitiesSource = &allPossibilities;
+    const std::atomic<uint32_t> failBound(xFails);
+    return TestAllPossibilitiesUntilPassXFails(allPossibilities, failBound);
+}
+
+uint32_t NumWordB::NumberWordStrategy::TestAllPossibilitiesUntilPassXFails(const std::vector<NumberWord>& allPossibilities, const std::atomic<uint32_t>& xFails)
+{
+    SetRemainingPossibilitiesSource(allPossibilities);
 
     if (HasPrintBehavior(PrintBehavior::kInputWord))
     {
@@ -71,15 +145,43 @@ uint32_t NumWordB::NumberWordStrategy::TestAllPossibilitiesUntilPassXFails(const
         wordsBeforeProgress = 1;
     }
 
+    // Every target is solved at once by splitting the whole set on each guess, then tallied in the original order
+    std::vector<size_t> stepsForTarget(allPossibilities.size(), 0);
+    mNumFails = 0;
+    if (!allPossibilities.empty())
+    {
+        mCurrentStep = mContext->GetConfiguration().mStartingStep;
+        mGuessHistory.clear();
+        uint16_t* const targetPositions = mStepArena.GetStep(mCurrentStep);
+        for (size_t i = 0; i < allPossibilities.size(); ++i)
+        {
+            targetPositions[i] = static_cast<uint16_t>(i);
+        }
+        mFailBound = &xFails;
+        SolvePartition(allPossibilities, targetPositions, allPossibilities.size(), stepsForTarget, nullptr);
+        mFailBound = nullptr;
+    }
+
+    // Targets left unsolved when solving gave up have no steps, the tally below only sees the ones solved
+    const uint32_t finalFailBound = xFails.load(std::memory_order_relaxed);
+    const bool hasPassedFailBound = (mNumFails > finalFailBound);
+
     std::map<size_t, std::vector<NumberWord>> stepsToWords;
 
     uint32_t fails = 0;
     uint32_t wordsProcessedBeforePrint = 0;
     uint32_t totalStepsUsed = 0;
-    for (const NumberWord& targetWord : allPossibilities)
+    mTargetsBySteps.assign(kMaxSteps + 2, 0);
+    for (size_t targetPosition = 0; targetPosition < allPossibilities.size(); ++targetPosition)
     {
-        const size_t steps = TestSpecificWord(targetWord);
+        const NumberWord& targetWord = allPossibilities[targetPosition];
+        const size_t steps = stepsForTarget[targetPosition];
         totalStepsUsed += static_cast<uint32_t>(steps);
+        if (steps >= mTargetsBySteps.size())
+        {
+            mTargetsBySteps.resize(steps + 1, 0);
+        }
+        ++mTargetsBySteps[steps];
         if (steps > kMaxSteps)
         {
             ++fails;
@@ -88,7 +190,7 @@ uint32_t NumWordB::NumberWordStrategy::TestAllPossibilitiesUntilPassXFails(const
             {
                 stepsToWords[steps].push_back(targetWord);
             }
-            if (fails > xFails)
+            if (fails > finalFailBound)
             {
                 break;
             }
@@ -112,6 +214,11 @@ uint32_t NumWordB::NumberWordStrategy::TestAllPossibilitiesUntilPassXFails(const
         }
     }
 
+    if (hasPassedFailBound)
+    {
+        fails = finalFailBound + 1;
+    }
+
     //
     // End Data to store on the strategy
     //
@@ -130,6 +237,11 @@ uint32_t NumWordB::NumberWordStrategy::TestAllPossibilitiesUntilPassXFails(const
         printf(" - Avg Steps %.4f", mAverageStepsToSolve);
     }
 
+    if (HasPrintBehavior(PrintBehavior::kShowMemoStats))
+    {
+        printf(" - Memo %zu hits, %zu misses, %zu entries", mMemoHits, mMemoMisses, mMemo.size());
+    }
+
     if (HasPrintBehavior(PrintBehavior::kShowSuccessPossibilitiesOverThree))
     {
         size_t steps = 4;
@@ -167,11 +279,336 @@ uint32_t NumWordB::NumberWordStrategy::TestAllPossibilitiesUntilPassXFails(const
     return fails;
 }
 
-bool NumWordB::NumberWordStrategy::ProceedToNextStepWithPattern(uint16_t pattern)
+uint32_t NumWordB::NumberWordStrategy::SolvePartition(const std::vector<NumberWord>& allPossibilities, const uint16_t* const targetPositions, const size_t numTargets, std::vector<size_t>& outStepsForTarget, DecisionTree* const outTree)
 {
+    // The targets here are exactly the possibilities still consistent with every result so far, so one guess
+    // serves all of them, and each pattern it can give leads to the next such set. targetPositions are positions in
+    // allPossibilities, held by the arena for the step before this one.
+    const StepStrategy currentStrategy = mContext->GetConfiguration().GetStepStrategy(mCurrentStep);
+    ++mCurrentStep;
+
+    // Past the last step every target here fails however it is solved, so it can be counted right away
+    if ((mCurrentStep > kMaxSteps) && (mFailBound != nullptr))
+    {
+        const uint32_t numFailsAfter = mNumFails + static_cast<uint32_t>(numTargets);
+        if (numFailsAfter > mFailBound->load(std::memory_order_relaxed))
+        {
+            mNumFails = numFailsAfter;
+            return DecisionTree::kNoNode;
+        }
+    }
+
+    NumberWord guess(kInvalidNumberWord);
+    if (!FindMemoizedWord(currentStrategy, guess))
+    {
+        mRemainingPossibilities.clear();
+        for (size_t i = 0; i < numTargets; ++i)
+        {
+            mRemainingPossibilities.push_back(allPossibilities[targetPositions[i]]);
+        }
+        mRemainingPossibilitySet = PossibilitySet(mRemainingPossibilities);
+        guess = GetOptimalWordFromStrategy(currentStrategy);
+        StoreMemoizedWord(currentStrategy, guess);
+    }
+    const size_t step = mCurrentStep;
+
+    // The targets bucketed by pattern go into this step's arena buffer, and each bucket is handed to its child as is.
+    // Only the guess itself gives the perfect match, and it is solved right here.
+    PatternPartition partition;
+    partition.Assign(guess, allPossibilities, targetPositions, numTargets, mStepArena.GetStep(step));
+    if (partition.GetBucketSize(kPerfectMatch) != 0)
+    {
+        outStepsForTarget[*partition.GetBucket(kPerfectMatch)] = step;
+        mNumFails += (step > kMaxSteps) ? 1 : 0;
+    }
+
+    uint32_t treeNode = DecisionTree::kNoNode;
+    if (outTree != nullptr)
+    {
+        MatchPattern edgePatterns[kNumMatchPatterns];
+        size_t numEdges = 0;
+        for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+        {
+            if (partition.GetBucketSize(static_cast<MatchPattern>(pattern)) != 0)
+            {
+                edgePatterns[numEdges++] = static_cast<MatchPattern>(pattern);
+            }
+        }
+        treeNode = outTree->AddNode(guess, edgePatterns, numEdges);
+    }
+
+    size_t edge = 0;
+    for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+    {
+        const size_t bucketSize = partition.GetBucketSize(static_cast<MatchPattern>(pattern));
+        if (bucketSize == 0)
+        {
+            continue;
+        }
+
+        mCurrentStep = step;
+        mGuessHistory.push_back((static_cast<uint32_t>(guess.mIndex) << 8) | static_cast<uint32_t>(pattern));
+        const uint32_t childNode = SolvePartition(allPossibilities, partition.GetBucket(static_cast<MatchPattern>(pattern)), bucketSize, outStepsForTarget, outTree);
+        mGuessHistory.pop_back();
+        if (outTree != nullptr)
+        {
+            outTree->SetChildNode(treeNode, edge++, childNode);
+        }
+        if (HasPassedFailBound())
+        {
+            break;
+        }
+    }
+    return treeNode;
+}
+
+uint64_t NumWordB::NumberWordStrategy::GetConfigurationHash(const std::vector<NumberWord>& allPossibilities) const
+{
+    if (mContext->HasSource(allPossibilities))
+    {
+        return mContext->GetConfigurationHash();
+    }
+    return SolverContext::GetConfigurationHash(mContext->GetConfiguration(), allPossibilities);
+}
+
+void NumWordB::NumberWordStrategy::CompileDecisionTree(const std::vector<NumberWord>& allPossibilities, DecisionTree& outTree)
+{
+    SetRemainingPossibilitiesSource(allPossibilities);
+    outTree.Reset(GetConfigurationHash(allPossibilities));
+    if (allPossibilities.empty())
+    {
+        return;
+    }
+
+    std::vector<size_t> stepsForTarget(allPossibilities.size(), 0);
+    mCurrentStep = mContext->GetConfiguration().mStartingStep;
+    mGuessHistory.clear();
+    uint16_t* const targetPositions = mStepArena.GetStep(mCurrentStep);
+    for (size_t i = 0; i < allPossibilities.size(); ++i)
+    {
+        targetPositions[i] = static_cast<uint16_t>(i);
+    }
+    SolvePartition(allPossibilities, targetPositions, allPossibilities.size(), stepsForTarget, &outTree);
+
+    size_t totalStepsUsed = 0;
+    for (const size_t steps : stepsForTarget)
+    {
+        totalStepsUsed += steps;
+    }
+    mAverageStepsToSolve = static_cast<double>(totalStepsUsed) / static_cast<double>(allPossibilities.size());
+}
+
+bool NumWordB::NumberWordStrategy::UseDecisionTree(const DecisionTree& tree)
+{
+    if (tree.IsEmpty() || (tree.GetConfigurationHash() != mContext->GetConfigurationHash()))
+    {
+        return false;
+    }
+    mDecisionTree = &tree;
+    return true;
+}
+
+void NumWordB::NumberWordStrategy::SetOpeningBookSteps()
+{
+    // The two steps after the opener, where the sets are largest and a search costs the most
+    SolverConfiguration configuration = mContext->GetConfiguration();
+    configuration.mStepStrategies[1] = StepStrategy::kOpeningBook;
+    configuration.mStepStrategies[2] = StepStrategy::kOpeningBook;
+    Reconfigure(configuration);
+}
+
+void NumWordB::NumberWordStrategy::CompileOpeningBook(const std::vector<NumberWord>& allPossibilities, const size_t guessBreadth, OpeningBook& outBook)
+{
+    struct BookSearch
+    {
+        MatchPattern mFirstPattern;
+        uint8_t mSecondPattern;
+        std::vector<NumberWord> mPossibilities;
+        NumberWord mGuess;
+    };
+
+    SetRemainingPossibilitiesSource(allPossibilities);
+    SetOpeningBookSteps();
+    ResetRemainingPossibilities();
+    const SolverConfiguration& configuration = mContext->GetConfiguration();
+    const NumberWord opener = GetOptimalWordFromStrategy(configuration.mStepStrategies[0]);
+    outBook.Reset(mContext->GetConfigurationHash(), opener);
+
+    // Games are played out the way they would go without the book, from the step searched for on
+    SolverConfiguration playOutConfiguration = configuration;
+    for (StepStrategy& stepStrategy : playOutConfiguration.mStepStrategies)
+    {
+        stepStrategy = (stepStrategy == StepStrategy::kOpeningBook) ? StepStrategy::kOptimalPatternMatch : stepStrategy;
+    }
+
+    ThreadPool& threadPool = ThreadPool::Get();
+    std::vector<std::unique_ptr<NumberWordStrategy>> workers(threadPool.GetNumWorkers());
+    std::vector<std::shared_ptr<const SolverContext>> contexts;
+    const auto runSearches = [&](std::vector<BookSearch>& searches, const size_t step)
+    {
+        // Largest sets first, so no worker is left with a large one at the end
+        std::stable_sort(searches.begin(), searches.end(),
+            [](const BookSearch& a, const BookSearch& b) { return a.mPossibilities.size() > b.mPossibilities.size(); });
+        SolverConfiguration searchConfiguration = playOutConfiguration;
+        searchConfiguration.mStepStrategies[step - 1] = StepStrategy::kUseInputWord;
+        searchConfiguration.mStartingStep = step - 1;
+        contexts.clear();
+        for (const BookSearch& search : searches)
+        {
+            contexts.push_back(std::make_shared<const SolverContext>(searchConfiguration, search.mPossibilities, mContext->GetDictionary()));
+        }
+
+        threadPool.RunWorkStealing(searches.size(), [&](size_t workerIndex, size_t search)
+        {
+            if (!workers[workerIndex])
+            {
+                workers[workerIndex].reset(new NumberWordStrategy(contexts[search]));
+            }
+            searches[search].mGuess = workers[workerIndex]->FindGuessByPlayingOut(contexts[search], guessBreadth);
+            return true;
+        });
+    };
+    // Bucketed in source order, which the searches' tie-breaks depend on
+    std::vector<BookSearch> firstSearches;
+    {
+        std::vector<std::vector<NumberWord>> buckets(kNumMatchPatterns);
+        for (const NumberWord& possibility : allPossibilities)
+        {
+            buckets[possibility.GetTestResults(opener)].push_back(possibility);
+        }
+        for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+        {
+            if (!buckets[pattern].empty())
+            {
+                firstSearches.push_back({ static_cast<MatchPattern>(pattern), OpeningBook::kNoPattern, std::move(buckets[pattern]), kInvalidNumberWord });
+            }
+        }
+    }
+    runSearches(firstSearches, 2);
+
+    std::vector<BookSearch> secondSearches;
+    for (const BookSearch& firstSearch : firstSearches)
+    {
+        outBook.AddGuess(firstSearch.mFirstPattern, firstSearch.mSecondPattern, firstSearch.mGuess);
+        std::vector<std::vector<NumberWord>> buckets(kNumMatchPatterns);
+        for (const NumberWord& possibility : firstSearch.mPossibilities)
+        {
+            buckets[possibility.GetTestResults(firstSearch.mGuess)].push_back(possibility);
+        }
+        for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+        {
+            if (!buckets[pattern].empty())
+            {
+                secondSearches.push_back({ firstSearch.mFirstPattern, static_cast<uint8_t>(pattern), std::move(buckets[pattern]), kInvalidNumberWord });
+            }
+        }
+    }
+    runSearches(secondSearches, 3);
+
+    for (const BookSearch& secondSearch : secondSearches)
+    {
+        outBook.AddGuess(secondSearch.mFirstPattern, secondSearch.mSecondPattern, secondSearch.mGuess);
+    }
+}
+
+NumberWord NumWordB::NumberWordStrategy::FindGuessByPlayingOut(std::shared_ptr<const SolverContext> context, const size_t guessBreadth)
+{
+    UseContext(std::move(context));
+    const std::vector<NumberWord>& possibilities = mContext->GetSource();
+    mRemainingPossibilities = possibilities;
+    const NumberWord fallbackGuess = FindOptimalPatternMatch();
+    if (possibilities.size() < 3)
+    {
+        return fallbackGuess;
+    }
+
+    // The candidates are the test words splitting the possibilities best, one of each class of guesses splitting them
+    // alike, the fallback's first
+    std::vector<uint64_t> candidateKeys;
+    {
+        SelectTestWords(false, false);
+        MatchPatternLookup& lookup = mStepArena.GetLookup();
+        lookup.Assign(mRemainingPossibilities);
+        uint16_t histogram[kMatchPatternHistogramSize];
+        for (const uint16_t testWordIndex : mSelectedTestWords)
+        {
+            // A position in the test words, which is only the word's kWordList index while every word is in use
+            const NumberWord& testWord = mContext->GetTestWords()[testWordIndex];
+            if (testWord == fallbackGuess)
+            {
+                continue;
+            }
+            std::fill(std::begin(histogram), std::end(histogram), static_cast<uint16_t>(0));
+            lookup.AddTestResultsToHistogram(testWord, histogram);
+            uint64_t largestMatchSet = 0;
+            uint64_t sumOfSquares = 0;
+            for (const uint16_t setSize : histogram)
+            {
+                largestMatchSet = std::max<uint64_t>(largestMatchSet, setSize);
+                sumOfSquares += static_cast<uint64_t>(setSize) * setSize;
+            }
+            candidateKeys.push_back((largestMatchSet << 48) | (sumOfSquares << 16) | testWordIndex);
+        }
+    }
+    const size_t numOtherCandidates = (guessBreadth == 0) ? candidateKeys.size() : std::min(candidateKeys.size(), guessBreadth - 1);
+    std::partial_sort(candidateKeys.begin(), candidateKeys.begin() + numOtherCandidates, candidateKeys.end());
+    candidateKeys.resize(numOtherCandidates);
+
+    NumberWord bestGuess = fallbackGuess;
+    uint32_t bestFails = UINT32_MAX;
+    uint64_t bestTotalSteps = UINT64_MAX;
+    for (size_t candidate = 0; candidate <= candidateKeys.size(); ++candidate)
+    {
+        const NumberWord guess = (candidate == 0) ? fallbackGuess : mContext->GetTestWords()[candidateKeys[candidate - 1] & 0xFFFF];
+        SetInputWord(guess);
+        const uint32_t fails = TestAllPossibilitiesUntilPassXFails(possibilities, bestFails);
+        if (fails > bestFails)
+        {
+            continue;
+        }
+
+        uint64_t totalSteps = 0;
+        for (size_t steps = 0; steps < mTargetsBySteps.size(); ++steps)
+        {
+            totalSteps += steps * mTargetsBySteps[steps];
+        }
+        if ((fails < bestFails) || (totalSteps < bestTotalSteps))
+        {
+            bestGuess = guess;
+            bestFails = fails;
+            bestTotalSteps = totalSteps;
+        }
+    }
+    return bestGuess;
+}
+
+bool NumWordB::NumberWordStrategy::UseOpeningBook(const OpeningBook& book)
+{
+    std::shared_ptr<const SolverContext> previousContext = mContext;
+    SetOpeningBookSteps();
+    if (book.IsEmpty() || (book.GetConfigurationHash() != mContext->GetConfigurationHash()))
+    {
+        mContext = std::move(previousContext);
+        return false;
+    }
+    mOpeningBook = &book;
+    mOpeningBookSourceHash = mContext->GetSourceHash();
+    // Opening book steps remembered from another book would otherwise be played over this one's
+    mMemo.clear();
+    return true;
+}
+
+bool NumWordB::NumberWordStrategy::ProceedToNextStepWithPattern(MatchPattern pattern)
+{
+    // Only ever good for the step it was provided for
+    const bool hasProvidedGuess = (mProvidedGuess != kInvalidNumberWord) && (mProvidedPattern == pattern) && (mCurrentStep != 0);
+    const NumberWord providedGuess = mProvidedGuess;
+    mProvidedGuess = kInvalidNumberWord;
+
     if (mCurrentStep == 0)
     {
-        mRemainingPossibilities = *mRemainingPossibilitiesSource;
+        ResetRemainingPossibilities();
+        mDecisionTreeNode = (mDecisionTree != nullptr) ? DecisionTree::kRootNode : DecisionTree::kNoNode;
     }
     else
     {
@@ -182,206 +619,703 @@ bool NumWordB::NumberWordStrategy::ProceedToNextStepWithPattern(uint16_t pattern
         }
 
         PairDownRemainingPossibilities(pattern, mCurrentInputWord);
+        mGuessHistory.push_back((static_cast<uint32_t>(mCurrentInputWord.mIndex) << 8) | pattern);
+        if (mDecisionTreeNode != DecisionTree::kNoNode)
+        {
+            mDecisionTreeNode = mDecisionTree->GetChildNode(mDecisionTreeNode, pattern);
+        }
         if (mRemainingPossibilities.size() == 0)
         {
             return true;
         }
     }
 
-    const StepStrategy currentStrategy = (mCurrentStep < kMaxSteps) ? mStepStrategies[mCurrentStep] : kStrategyPostMax;
+    const StepStrategy currentStrategy = mContext->GetConfiguration().GetStepStrategy(mCurrentStep);
     ++mCurrentStep;
-    mCurrentInputWord = GetOptimalWordFromStrategy(currentStrategy);
+    // The tree holds the very guess the strategy would search for, as long as play has stayed on its paths
+    mIsCurrentInputWordProvenOptimal = true;
+    if (mDecisionTreeNode != DecisionTree::kNoNode)
+    {
+        mCurrentInputWord = mDecisionTree->GetGuess(mDecisionTreeNode);
+    }
+    else if (hasProvidedGuess)
+    {
+        mCurrentInputWord = providedGuess;
+        StoreMemoizedWord(currentStrategy, mCurrentInputWord);
+    }
+    else if (!FindMemoizedWord(currentStrategy, mCurrentInputWord))
+    {
+        mWasSearchCutShort = false;
+        if (mStepTimeBudget.count() > 0)
+        {
+            mStepDeadline = std::chrono::steady_clock::now() + mStepTimeBudget;
+        }
+        mCurrentInputWord = GetOptimalWordFromStrategy(currentStrategy);
+        mStepDeadline = std::chrono::steady_clock::time_point::max();
+
+        // A guess from a search cut short is only the best of what got scored, and must not stand in for a full one
+        mIsCurrentInputWordProvenOptimal = !mWasSearchCutShort;
+        if (mIsCurrentInputWordProvenOptimal)
+        {
+            StoreMemoizedWord(currentStrategy, mCurrentInputWord);
+        }
+    }
     return true;
 }
 
+void NumWordB::NumberWordStrategy::ProvideNextGuess(const MatchPattern pattern, const NumberWord& guess)
+{
+    mProvidedPattern = pattern;
+    mProvidedGuess = guess;
+}
+
 void NumWordB::NumberWordStrategy::PrintOptimalWordWithInstructions()
 {
     printf("\n\nINPUT THE FOLLOWING WORD:");
     PrintWord(mCurrentStep, mCurrentInputWord);
+    if (!mIsCurrentInputWordProvenOptimal)
+    {
+        printf(" (best found in %lldms, not proven optimal)", static_cast<long long>(mStepTimeBudget.count()));
+    }
     printf("\n\nTHEN INPUT THE WORDLE RESULT.\n * 0 for a miss.\n * 1 for a partial (yellow).\n * 2 for a hit (green)\n\n");
 }
 
+void NumWordB::NumberWordStrategy::UseContext(std::shared_ptr<const SolverContext> context)
+{
+    mContext = std::move(context);
+    mCurrentStep = 0;
+    mDecisionTreeNode = DecisionTree::kNoNode;
+}
+
+void NumWordB::NumberWordStrategy::Reconfigure(const SolverConfiguration& configuration)
+{
+    mContext = std::make_shared<const SolverContext>(configuration, *mContext);
+}
+
 void NumWordB::NumberWordStrategy::SetStrategy(StepStrategy stepStrategyList[kMaxSteps])
 {
-    memcpy(mStepStrategies, stepStrategyList, sizeof(kDefaultStrategies));
+    SolverConfiguration configuration = mContext->GetConfiguration();
+    memcpy(configuration.mStepStrategies, stepStrategyList, sizeof(configuration.mStepStrategies));
+    Reconfigure(configuration);
 }
 
 void NumWordB::NumberWordStrategy::SetSpecificStepStrategy(size_t step, StepStrategy stepStrategy)
 {
-    mStepStrategies[step - 1] = stepStrategy;
+    SolverConfiguration configuration = mContext->GetConfiguration();
+    configuration.mStepStrategies[step - 1] = stepStrategy;
+    Reconfigure(configuration);
 }
 
 void NumWordB::NumberWordStrategy::SetInputWord(const NumberWord& inputWord)
 {
+    // A different word than the tree's guess takes play off the tree, the search takes over from there
+    if ((mDecisionTreeNode != DecisionTree::kNoNode) && (mDecisionTree->GetGuess(mDecisionTreeNode) != inputWord))
+    {
+        mDecisionTreeNode = DecisionTree::kNoNode;
+    }
     mCurrentInputWord = inputWord;
 }
 
 void NumWordB::NumberWordStrategy::SetSpecialWord1(const NumberWord& specialWord1)
 {
-    mSpecialWord1 = specialWord1;
+    SolverConfiguration configuration = mContext->GetConfiguration();
+    configuration.mSpecialWord1 = specialWord1;
+    Reconfigure(configuration);
 }
 
 void NumWordB::NumberWordStrategy::SetSpecialWord2(const NumberWord& specialWord2)
 {
-    mSpecialWord2 = specialWord2;
+    SolverConfiguration configuration = mContext->GetConfiguration();
+    configuration.mSpecialWord2 = specialWord2;
+    Reconfigure(configuration);
 }
 
 void NumWordB::NumberWordStrategy::SetStartingStep(size_t step)
 {
-    mStartingStep = step - 1;
+    SolverConfiguration configuration = mContext->GetConfiguration();
+    configuration.mStartingStep = step - 1;
+    Reconfigure(configuration);
 }
 
 void NumWordB::NumberWordStrategy::AddPrintBehavior(PrintBehavior printBehavior)
 {
-    mPrintBehavior = static_cast<PrintBehavior>(static_cast<uint8_t>(mPrintBehavior) | static_cast<uint8_t>(printBehavior));
+    mPrintBehavior = static_cast<PrintBehavior>(static_cast<uint16_t>(mPrintBehavior) | static_cast<uint16_t>(printBehavior));
 }
 
 bool NumWordB::NumberWordStrategy::HasPrintBehavior(PrintBehavior printBehavior) const
 {
-    return (static_cast<uint8_t>(mPrintBehavior)& static_cast<uint8_t>(printBehavior)) != 0;
+    return (static_cast<uint16_t>(mPrintBehavior)& static_cast<uint16_t>(printBehavior)) != 0;
 }
 
 
 
-void NumWordB::NumberWordStrategy::PairDownSpecificPossibilities(uint16_t sourceMatch, const NumberWord& entryWord, std::vector<NumberWord>& possibilities) const
+void NumWordB::NumberWordStrategy::SetRemainingPossibilitiesSource(const std::vector<NumberWord>& source)
 {
-    std::vector<NumberWord> newPossibilities;
-    newPossibilities.reserve(possibilities.size() >> 1);
-    for (const NumberWord& possibility : possibilities)
+    // Solving the context's own source again, as every sweep does, keeps the context and whoever shares it. That is
+    // decided by the words, a vector refilled since the context was made gets a new one.
+    if (!mContext->HasSource(source))
     {
-        if (possibility.IsValidWith(entryWord, sourceMatch))
-        {
-            newPossibilities.emplace_back(possibility);
-        }
+        mContext = std::make_shared<const SolverContext>(mContext->GetConfiguration(), source, mContext->GetDictionary());
     }
-    possibilities.swap(newPossibilities);
 }
 
-void NumWordB::NumberWordStrategy::PairDownRemainingPossibilities(uint16_t sourceMatch, const NumberWord& entryWord)
+void NumWordB::NumberWordStrategy::ResetRemainingPossibilities()
 {
-    PairDownSpecificPossibilities(sourceMatch, entryWord, mRemainingPossibilities);
+    mRemainingPossibilities = mContext->GetSource();
+    mRemainingPossibilitySet = mContext->GetSourceSet();
+    mGuessHistory.clear();
 }
 
-const NumberWord NumWordB::NumberWordStrategy::FindOptimalPatternMatch() const
+void NumWordB::NumberWordStrategy::RestoreRemainingPossibilitiesFromSet()
 {
-    if (mRemainingPossibilities.size() < 3)
+    mRemainingPossibilities = mContext->GetSource();
+    mRemainingPossibilitySet.FilterWords(mRemainingPossibilities);
+}
+
+const std::vector<uint32_t>& NumWordB::NumberWordStrategy::MakeMemoKey(StepStrategy strategy)
+{
+    // Built in place each time, a lookup only allocates when a new entry is stored
+    std::vector<uint32_t>& key = mMemoKey;
+    key.clear();
+    const uint64_t sourceHash = mContext->GetSourceHash();
+    key.push_back(static_cast<uint32_t>(sourceHash));
+    key.push_back(static_cast<uint32_t>(sourceHash >> 32));
+    key.push_back(static_cast<uint32_t>(strategy));
+    // The searches guess from the test words, which shrink while the small set is in use
+    key.push_back(static_cast<uint32_t>(mContext->GetTestWords().size()));
+    key.insert(key.end(), mGuessHistory.begin(), mGuessHistory.end());
+    return key;
+}
+
+bool NumWordB::NumberWordStrategy::CanMemoize(StepStrategy strategy) const
+{
+    // Only searches are worth remembering, and printing alternatives needs the search to run
+    const bool isSearch = (strategy == StepStrategy::kOptimalPatternMatch) || (strategy == StepStrategy::kOptimalPatternMatchWithAlternatives)
+        || (strategy == StepStrategy::kOpeningBook) || (strategy == StepStrategy::kMaxEntropy) || (strategy == StepStrategy::kMinExpectedSize);
+    return isSearch && !HasPrintBehavior(PrintBehavior::kPrintPatternMatchAlternatives);
+}
+
+bool NumWordB::NumberWordStrategy::FindMemoizedWord(StepStrategy strategy, NumberWord& outWord)
+{
+    if (!CanMemoize(strategy))
     {
-        return mRemainingPossibilities.at(0);
+        return false;
     }
 
-    // What testWord, when applied, would result in a set of match patterns with the least entries in its largest sized match
+    const auto iter = mMemo.find(MakeMemoKey(strategy));
+    if (iter == mMemo.end())
+    {
+        ++mMemoMisses;
+        return false;
+    }
+    ++mMemoHits;
+    outWord = iter->second;
+    return true;
+}
+
+void NumWordB::NumberWordStrategy::StoreMemoizedWord(StepStrategy strategy, const NumberWord& word)
+{
+    // Roughly 100 bytes an entry, emptied when full rather than tracking what is least used
+    const size_t kMaxMemoEntries = 1 << 18;
+    if (!CanMemoize(strategy))
+    {
+        return;
+    }
+
+    if (mMemo.size() >= kMaxMemoEntries)
+    {
+        mMemo.clear();
+    }
+    mMemo.emplace(MakeMemoKey(strategy), word);
+}
 
-    uint16_t currentLowestLargeSetSize = UINT16_MAX;
-    NumberWord currentOptimalWord = kInvalidNumberWord;
+void NumWordB::NumberWordStrategy::PairDownRemainingPossibilitySet(MatchPattern sourceMatch, const NumberWord& entryWord)
+{
+    const size_t kMaxWordsToNarrowByLookup = 512;
 
-    for (const NumberWord& testWord : NumberWord::sAllWords)
+    // The first guess narrows the whole source, which the context has already done once for every game
+    const PossibilitySet* const firstGuessSet = mGuessHistory.empty() ? mContext->FindFirstGuessSet(entryWord, sourceMatch) : nullptr;
+    if (firstGuessSet != nullptr)
     {
-        uint16_t matchPatterns[1024] = { 0 };
-        for (const NumberWord& possibility : mRemainingPossibilities)
+        mRemainingPossibilitySet = *firstGuessSet;
+    }
+    else if (mRemainingPossibilitySet.Count() > kMaxWordsToNarrowByLookup)
+    {
+        // Too many words left for a pattern lookup each, one shared mask does it for all of them
+        mRemainingPossibilitySet.KeepOnlyMatching(entryWord, sourceMatch);
+    }
+    else
+    {
+        mRemainingPossibilitySet.KeepOnlyMatchingByLookup(entryWord, sourceMatch);
+    }
+}
+
+void NumWordB::NumberWordStrategy::PairDownRemainingPossibilities(MatchPattern sourceMatch, const NumberWord& entryWord)
+{
+    PairDownRemainingPossibilitySet(sourceMatch, entryWord);
+    mRemainingPossibilitySet.FilterWords(mRemainingPossibilities);
+}
+
+double NumWordB::NumberWordStrategy::GetPruningRatio() const
+{
+    return (mNumTestWordsConsidered != 0) ? 1. - (static_cast<double>(mNumTestWordsScored) / static_cast<double>(mNumTestWordsConsidered)) : 0.;
+}
+
+void NumWordB::NumberWordStrategy::SelectTestWords(const bool preferHigherLetterValue, const bool keepEveryWord) const
+{
+    // A letter no remaining possibility has is a miss wherever a test word puts it, so test words differing only in
+    // such letters split the possibilities exactly alike and only one of each class needs scoring. Which one doesn't
+    // matter to the score, so it is the first in dictionary order, or the first with the highest letter value when
+    // that breaks ties. A test word of nothing but absent letters and letters every possibility has in the same
+    // place can't split them at all, and can never beat one that does. Gathering every tie keeps every word.
+    const size_t kNumClassSlots = 1 << 15;
+    const uint32_t kNoLetter = UINT32_MAX;
+    const std::vector<NumberWord>& testWords = mContext->GetTestWords();
+    std::vector<uint16_t>& selected = mSelectedTestWords;
+    selected.clear();
+    mNumTestWordsConsidered += testWords.size();
+
+    uint32_t presentLetters = 0;
+    uint32_t resolvedLetters[kWordLength];
+    for (size_t i = 0; i < kWordLength; ++i)
+    {
+        resolvedLetters[i] = (mRemainingPossibilities.front().mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+    }
+    for (const NumberWord& possibility : mRemainingPossibilities)
+    {
+        for (size_t i = 0; i < kWordLength; ++i)
         {
-            const uint16_t pattern = possibility.GetTestResults(testWord) - kEarmarkMatchPattern;
-            matchPatterns[pattern] += 1;
+            const uint32_t letter = (possibility.mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+            presentLetters |= 1u << letter;
+            resolvedLetters[i] = (resolvedLetters[i] == letter) ? letter : kNoLetter;
         }
+    }
+
+    if (mTestWordClassSlots.size() != kNumClassSlots)
+    {
+        mTestWordClassSlots.assign(kNumClassSlots, TestWordClassSlot());
+    }
+    if (++mTestWordClassGeneration == 0)
+    {
+        std::fill(mTestWordClassSlots.begin(), mTestWordClassSlots.end(), TestWordClassSlot());
+        mTestWordClassGeneration = 1;
+    }
 
-        uint16_t largestSetSize = 0;
-        for (size_t i = 0; i < 1024; ++i)
+    bool isSelectedSorted = true;
+    for (size_t index = 0; (index < testWords.size()) && !keepEveryWord; ++index)
+    {
+        uint32_t key = 0;
+        bool canSplit = false;
+        for (size_t i = 0; i < kWordLength; ++i)
         {
-            if (matchPatterns[i] > largestSetSize)
+            const uint32_t letter = (testWords[index].mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+            if ((presentLetters & (1u << letter)) != 0)
             {
-                largestSetSize = matchPatterns[i];
+                key |= letter << (i * kBitsPerLetter);
+                canSplit |= (letter != resolvedLetters[i]);
             }
         }
+        if (!canSplit)
+        {
+            continue;
+        }
 
-        if (largestSetSize < currentLowestLargeSetSize)
+        size_t slot = (key * 0x9E3779B1u) >> (32 - 15);
+        for (; (mTestWordClassSlots[slot].mGeneration == mTestWordClassGeneration) && (mTestWordClassSlots[slot].mKey != key); slot = (slot + 1) & (kNumClassSlots - 1))
         {
-            currentLowestLargeSetSize = largestSetSize;
-            currentOptimalWord = testWord;
+        }
+
+        TestWordClassSlot& classSlot = mTestWordClassSlots[slot];
+        if (classSlot.mGeneration != mTestWordClassGeneration)
+        {
+            classSlot.mKey = key;
+            classSlot.mGeneration = mTestWordClassGeneration;
+            classSlot.mSelectedIndex = static_cast<uint16_t>(selected.size());
+            selected.push_back(static_cast<uint16_t>(index));
+        }
+        else if (preferHigherLetterValue && (testWords[index].GetLetterValue() > testWords[selected[classSlot.mSelectedIndex]].GetLetterValue()))
+        {
+            selected[classSlot.mSelectedIndex] = static_cast<uint16_t>(index);
+            isSelectedSorted = false;
         }
     }
 
-    return currentOptimalWord;
+    // Nothing found to split them, as when the possibilities aren't dictionary words, leaves every word to score
+    if (selected.empty())
+    {
+        for (size_t index = 0; index < testWords.size(); ++index)
+        {
+            selected.push_back(static_cast<uint16_t>(index));
+        }
+    }
+    if (!isSelectedSorted)
+    {
+        std::sort(selected.begin(), selected.end());
+    }
+    mNumTestWordsScored += selected.size();
 }
 
-const NumberWord NumWordB::NumberWordStrategy::FindOptimalPatternMatchWithAlternatives() const
+void NumWordB::NumberWordStrategy::OrderTestWordsByPromise() const
 {
-    if (mRemainingPossibilities.size() < 3)
+    // A letter splits the possibilities most evenly when about half of them have it, anywhere or in that place. How
+    // evenly the letters of a test word split them is a cheap guess at how well the whole word will, good enough to
+    // score the likely best words before a deadline. Equal guesses stay in dictionary order.
+    const uint64_t numPossibilities = mRemainingPossibilities.size();
+    uint32_t numWithLetter[1 << kBitsPerLetter] = { 0 };
+    uint32_t numWithLetterAt[kWordLength][1 << kBitsPerLetter] = { { 0 } };
+    for (const NumberWord& possibility : mRemainingPossibilities)
     {
-        return mRemainingPossibilities.at(0);
+        uint32_t seenLetters = 0;
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            const uint32_t letter = (possibility.mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+            ++numWithLetterAt[i][letter];
+            numWithLetter[letter] += ((seenLetters & (1u << letter)) == 0) ? 1 : 0;
+            seenLetters |= 1u << letter;
+        }
     }
 
-    // What testWord, when applied, would result in a set of match patterns with the least entries in its largest sized match
+    const std::vector<NumberWord>& testWords = mContext->GetTestWords();
+    std::vector<uint64_t>& keys = mTestWordPromiseKeys;
+    keys.clear();
+    for (const uint16_t index : mSelectedTestWords)
+    {
+        uint64_t promise = 0;
+        uint32_t seenLetters = 0;
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            const uint32_t letter = (testWords[index].mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+            promise += numWithLetterAt[i][letter] * (numPossibilities - numWithLetterAt[i][letter]);
+            if ((seenLetters & (1u << letter)) == 0)
+            {
+                promise += numWithLetter[letter] * (numPossibilities - numWithLetter[letter]);
+            }
+            seenLetters |= 1u << letter;
+        }
+        keys.push_back((promise << 16) | (UINT16_MAX - index));
+    }
 
-    uint16_t currentLowestLargeSetSize = UINT16_MAX;
-    NumberWord currentOptimalWord = kInvalidNumberWord;
-    std::vector<NumberWord> alternatives;
+    std::sort(keys.begin(), keys.end(), std::greater<uint64_t>());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        mSelectedTestWords[i] = static_cast<uint16_t>(UINT16_MAX - (keys[i] & UINT16_MAX));
+    }
+}
+
+uint16_t NumWordB::NumberWordStrategy::FindLowestLargeSetSizeBound(const MatchPatternLookup& lookup) const
+{
+    // Test words covering the letters most common among the remaining possibilities tend to split them well,
+    // so the best of a handful of those is a good upper bound on what the full search will find
+    const size_t kNumSeedWords = 16;
+    const size_t kNumLetterValues = 1 << kBitsPerLetter;
 
-    for (const NumberWord& testWord : NumberWord::sAllWords)
+    uint32_t possibilitiesWithLetter[kNumLetterValues] = { 0 };
+    for (const NumberWord& possibility : mRemainingPossibilities)
     {
-        uint16_t matchPatterns[1024] = { 0 };
-        for (const NumberWord& possibility : mRemainingPossibilities)
+        uint32_t lettersSeen = 0;
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            lettersSeen |= 1u << ((possibility.mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter));
+        }
+        for (size_t letter = 1; letter < kNumLetterValues; ++letter)
         {
-            const uint16_t pattern = possibility.GetTestResults(testWord) - kEarmarkMatchPattern;
-            matchPatterns[pattern] += 1;
+            possibilitiesWithLetter[letter] += (lettersSeen >> letter) & 1u;
         }
+    }
 
-        uint16_t largestSetSize = 0;
-        for (size_t i = 0; i < 1024; ++i)
+    // Best coverage first, kept by insertion as the test words go by
+    const std::vector<NumberWord>& testWords = mContext->GetTestWords();
+    std::pair<uint32_t, size_t> seeds[kNumSeedWords];
+    size_t numSeedWords = 0;
+    for (size_t w = 0; w < testWords.size(); ++w)
+    {
+        const uint32_t value = testWords[w].mValue;
+        uint32_t lettersSeen = 0;
+        uint32_t coverage = 0;
+        for (size_t i = 0; i < kWordLength; ++i)
         {
-            if (matchPatterns[i] > largestSetSize)
+            const uint32_t letter = (value & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+            if ((lettersSeen & (1u << letter)) == 0)
             {
-                largestSetSize = matchPatterns[i];
+                lettersSeen |= 1u << letter;
+                coverage += possibilitiesWithLetter[letter];
             }
         }
 
-        if (largestSetSize < currentLowestLargeSetSize)
+        if ((numSeedWords == kNumSeedWords) && (coverage <= seeds[kNumSeedWords - 1].first))
         {
-            currentLowestLargeSetSize = largestSetSize;
-            currentOptimalWord = testWord;
-            alternatives.clear();
+            continue;
         }
-        else if (largestSetSize == currentLowestLargeSetSize)
+        size_t slot = (numSeedWords < kNumSeedWords) ? numSeedWords++ : (kNumSeedWords - 1);
+        for (; (slot > 0) && (seeds[slot - 1].first < coverage); --slot)
         {
-            alternatives.push_back(testWord);
+            seeds[slot] = seeds[slot - 1];
         }
+        seeds[slot] = std::make_pair(coverage, w);
     }
 
-    if (!alternatives.empty())
+    uint16_t lowestLargeSetSize = static_cast<uint16_t>(std::min<size_t>(mRemainingPossibilities.size(), UINT16_MAX - 1));
+    for (size_t i = 0; i < numSeedWords; ++i)
+    {
+        lowestLargeSetSize = std::min(lowestLargeSetSize, lookup.GetLargestBucketSize(testWords[seeds[i].second], lowestLargeSetSize));
+    }
+    return lowestLargeSetSize;
+}
+
+template <NumWordB::ScoreMetric kPrimaryMetric, NumWordB::ScoreMetric kTieBreakMetric, bool kCollectTies>
+uint64_t NumWordB::NumberWordStrategy::FindBestScoredTestWords(const MatchPatternLookup& lookup, std::vector<size_t>& outTestWordIndices) const
+{
+    static_assert((kPrimaryMetric != ScoreMetric::kNone) && (kPrimaryMetric != ScoreMetric::kLetterValue), "The primary metric scores the histogram");
+
+    // Only the largest match set is known to lose before its histogram is complete. Words tying the best primary
+    // score are only looked at when they are collected, the tie break could prefer them, or a deadline put the test
+    // words out of dictionary order.
+    constexpr bool kCanAbort = (kPrimaryMetric == ScoreMetric::kLargestMatchSet);
+    constexpr bool kNeedsTies = kCollectTies || (kTieBreakMetric != ScoreMetric::kNone);
+
+    // Each worker takes chunks of test words in increasing order and keeps its own best, with the dictionary order
+    // deciding what is still tied after the merge, exactly as one serial pass would. When counting can abort, a
+    // strictly better primary score found by one worker also cuts off the others, though only past ties, since an
+    // earlier tie still has to win.
+    const size_t kTestWordsPerChunk = 256;
+    SelectTestWords(kTieBreakMetric == ScoreMetric::kLetterValue, kCollectTies);
+    const bool hasDeadline = (mStepDeadline != std::chrono::steady_clock::time_point::max());
+    if (hasDeadline)
+    {
+        OrderTestWordsByPromise();
+    }
+    const std::vector<uint16_t>& selectedTestWords = mSelectedTestWords;
+    const size_t numChunks = (selectedTestWords.size() + kTestWordsPerChunk - 1) / kTestWordsPerChunk;
+    ThreadPool& threadPool = ThreadPool::Get();
+    std::vector<WorkerBest>& workerBests = mWorkerBests;
+    workerBests.resize(threadPool.GetNumWorkers());
+    for (WorkerBest& best : workerBests)
     {
-        uint8_t currentLetterValue = currentOptimalWord.GetLetterValue();
-        for (size_t i = 0; i < alternatives.size(); ++i)
+        best.mPrimaryScore = UINT64_MAX;
+        best.mTieBreakScore = UINT64_MAX;
+        best.mTestWordIndex = SIZE_MAX;
+        best.mTiedTestWordIndices.clear();
+    }
+    std::atomic<size_t> nextChunk(0);
+    std::atomic<bool> isCutShort(false);
+    std::atomic<uint64_t> sharedBestPrimaryScore(kCanAbort ? FindLowestLargeSetSizeBound(lookup) : UINT64_MAX);
+
+    // Everything the workers share, captured as one pointer so the std::function keeps it without allocating
+    struct SearchState
+    {
+        const MatchPatternLookup& mLookup;
+        const std::vector<NumberWord>& mTestWords;
+        const std::vector<uint16_t>& mSelectedTestWords;
+        std::vector<WorkerBest>& mWorkerBests;
+        std::atomic<size_t>& mNextChunk;
+        std::atomic<uint64_t>& mSharedBestPrimaryScore;
+        std::atomic<bool>& mIsCutShort;
+        const uint32_t* mNLog2N;
+        size_t mNumChunks;
+        bool mHasDeadline;
+        std::chrono::steady_clock::time_point mDeadline;
+        const std::atomic<bool>* mIsCancelled;
+    };
+    const SearchState state = { lookup, mContext->GetTestWords(), selectedTestWords, workerBests, nextChunk, sharedBestPrimaryScore, isCutShort,
+        GetNLog2NTable().data(), numChunks, hasDeadline, mStepDeadline, mIsCancelled };
+
+    threadPool.RunOnAllWorkers([&state](size_t workerIndex)
+    {
+        WorkerBest& best = state.mWorkerBests[workerIndex];
+        uint16_t histogram[kMatchPatternHistogramSize];
+        for (size_t chunk = state.mNextChunk++; chunk < state.mNumChunks; chunk = state.mNextChunk++)
         {
-            const uint8_t altLetterValue = alternatives.at(i).GetLetterValue();
-            if (altLetterValue > currentLetterValue)
+            // Checked between chunks, so the first, most promising one is always scored and the overrun is one chunk at most.
+            // A cancelled search has no use for anything it finds, and stops even before the first.
+            if ((state.mHasDeadline && (chunk != 0) && (std::chrono::steady_clock::now() >= state.mDeadline))
+                || ((state.mIsCancelled != nullptr) && state.mIsCancelled->load(std::memory_order_relaxed)))
             {
-                currentLetterValue = altLetterValue;
-                const NumberWord oldOptimalWord = currentOptimalWord;
-                currentOptimalWord = alternatives.at(i);
-                alternatives[i] = oldOptimalWord;
+                state.mIsCutShort.store(true, std::memory_order_relaxed);
+                break;
+            }
+
+            const size_t lastSelected = std::min((chunk + 1) * kTestWordsPerChunk, state.mSelectedTestWords.size());
+            for (size_t selected = chunk * kTestWordsPerChunk; selected < lastSelected; ++selected)
+            {
+                const size_t index = state.mSelectedTestWords[selected];
+                const NumberWord& testWord = state.mTestWords[index];
+                uint64_t primaryScore = 0;
+                if constexpr (kCanAbort)
+                {
+                    // Only a strictly smaller largest set replaces a worker's best, so counting can stop once a set
+                    // reaches it. When ties are needed, counting only stops once a set grows past it.
+                    const uint64_t ownCutoff = (best.mPrimaryScore == UINT64_MAX) ? UINT64_MAX : (best.mPrimaryScore + ((kNeedsTies || state.mHasDeadline) ? 1 : 0));
+                    const uint64_t sharedCutoff = state.mSharedBestPrimaryScore.load(std::memory_order_relaxed) + 1;
+                    const uint16_t abortAtSize = static_cast<uint16_t>(std::min(ownCutoff, sharedCutoff));
+                    const uint16_t largestSetSize = state.mLookup.GetLargestBucketSize(testWord, abortAtSize);
+                    if (largestSetSize >= abortAtSize)
+                    {
+                        continue;
+                    }
+                    primaryScore = largestSetSize;
+                }
+                else
+                {
+                    memset(histogram, 0, sizeof(histogram));
+                    state.mLookup.AddTestResultsToHistogram(testWord, histogram);
+                    primaryScore = ScoreHistogram<kPrimaryMetric>(histogram, state.mNLog2N);
+                }
+
+                if ((primaryScore > best.mPrimaryScore) || (!kNeedsTies && !state.mHasDeadline && (primaryScore == best.mPrimaryScore)))
+                {
+                    continue;
+                }
+
+                // A histogram metric breaking ties after the largest match set needs the histogram counted in full
+                uint64_t tieBreakScore = 0;
+                if constexpr (kTieBreakMetric == ScoreMetric::kLetterValue)
+                {
+                    tieBreakScore = UINT8_MAX - testWord.GetLetterValue();
+                }
+                else if constexpr (kTieBreakMetric != ScoreMetric::kNone)
+                {
+                    if constexpr (kCanAbort)
+                    {
+                        memset(histogram, 0, sizeof(histogram));
+                        state.mLookup.AddTestResultsToHistogram(testWord, histogram);
+                    }
+                    tieBreakScore = ScoreHistogram<kTieBreakMetric>(histogram, state.mNLog2N);
+                }
+
+                if (primaryScore == best.mPrimaryScore)
+                {
+                    if constexpr (kCollectTies)
+                    {
+                        best.mTiedTestWordIndices.push_back(index);
+                    }
+                    if ((tieBreakScore < best.mTieBreakScore) || ((tieBreakScore == best.mTieBreakScore) && (index < best.mTestWordIndex)))
+                    {
+                        best.mTieBreakScore = tieBreakScore;
+                        best.mTestWordIndex = index;
+                    }
+                    continue;
+                }
+
+                best.mPrimaryScore = primaryScore;
+                best.mTieBreakScore = tieBreakScore;
+                best.mTestWordIndex = index;
+                if constexpr (kCollectTies)
+                {
+                    best.mTiedTestWordIndices.clear();
+                    best.mTiedTestWordIndices.push_back(index);
+                }
+                if constexpr (kCanAbort)
+                {
+                    uint64_t sharedBest = state.mSharedBestPrimaryScore.load(std::memory_order_relaxed);
+                    while ((primaryScore < sharedBest) && !state.mSharedBestPrimaryScore.compare_exchange_weak(sharedBest, primaryScore))
+                    {
+                    }
+                }
             }
         }
+    });
 
-        if (HasPrintBehavior(PrintBehavior::kPrintPatternMatchAlternatives))
+    const WorkerBest* overallBest = &workerBests.front();
+    for (const WorkerBest& best : workerBests)
+    {
+        if (best.mPrimaryScore != overallBest->mPrimaryScore)
         {
-            std::string textForWord;
-            printf("\n\n ALTS");
-            PrintWordList(textForWord, alternatives, 12, false);
+            overallBest = (best.mPrimaryScore < overallBest->mPrimaryScore) ? &best : overallBest;
+        }
+        else if (best.mTieBreakScore != overallBest->mTieBreakScore)
+        {
+            overallBest = (best.mTieBreakScore < overallBest->mTieBreakScore) ? &best : overallBest;
+        }
+        else if (best.mTestWordIndex < overallBest->mTestWordIndex)
+        {
+            overallBest = &best;
         }
     }
 
-    return currentOptimalWord;
+    // Cut short before any scored word beat the seeded bound, the most promising word is still better than none
+    mWasSearchCutShort |= isCutShort.load(std::memory_order_relaxed);
+    outTestWordIndices.clear();
+    outTestWordIndices.push_back((overallBest->mTestWordIndex != SIZE_MAX) ? overallBest->mTestWordIndex : selectedTestWords.front());
+    if constexpr (kCollectTies)
+    {
+        for (const WorkerBest& best : workerBests)
+        {
+            if (best.mPrimaryScore != overallBest->mPrimaryScore)
+            {
+                continue;
+            }
+            for (const size_t index : best.mTiedTestWordIndices)
+            {
+                if (index != overallBest->mTestWordIndex)
+                {
+                    outTestWordIndices.push_back(index);
+                }
+            }
+        }
+        std::sort(outTestWordIndices.begin() + 1, outTestWordIndices.end());
+    }
+    return overallBest->mPrimaryScore;
 }
 
-const NumberWord NumWordB::NumberWordStrategy::SuperSpecialLogicForFindingOptimalWordIGuess() const
+template <NumWordB::ScoreMetric kPrimaryMetric, NumWordB::ScoreMetric kTieBreakMetric>
+const NumberWord NumWordB::NumberWordStrategy::FindBestScoredTestWord() const
 {
-    if (mStepResults[0] == 2049)
+    if (mRemainingPossibilities.size() < 3)
     {
-        if (mStepResults[1] == 2049)
-        {
-            return NumberWord::LookupNumberWord("banjo");
-        }
-        if (mStepResults[1] == 2440)
+        return mRemainingPossibilities.at(0);
+    }
+
+    MatchPatternLookup& lookup = mStepArena.GetLookup();
+    lookup.Assign(mRemainingPossibilities);
+    FindBestScoredTestWords<kPrimaryMetric, kTieBreakMetric, false>(lookup, mOptimalWordIndices);
+    return mContext->GetTestWords().at(mOptimalWordIndices.front());
+}
+
+const NumberWord NumWordB::NumberWordStrategy::FindOptimalPatternMatch() const
+{
+    // What testWord, when applied, would result in a set of match patterns with the least entries in its largest sized match
+    return FindBestScoredTestWord<ScoreMetric::kLargestMatchSet, ScoreMetric::kNone>();
+}
+
+const NumberWord NumWordB::NumberWordStrategy::FindOptimalPatternMatchWithAlternatives() const
+{
+    // Same, with the highest letter value breaking ties. The other tied words are only gathered to be printed.
+    if (!HasPrintBehavior(PrintBehavior::kPrintPatternMatchAlternatives))
+    {
+        return FindBestScoredTestWord<ScoreMetric::kLargestMatchSet, ScoreMetric::kLetterValue>();
+    }
+    if (mRemainingPossibilities.size() < 3)
+    {
+        return mRemainingPossibilities.at(0);
+    }
+
+    MatchPatternLookup& lookup = mStepArena.GetLookup();
+    lookup.Assign(mRemainingPossibilities);
+    std::vector<size_t>& optimalWordIndices = mOptimalWordIndices;
+    FindBestScoredTestWords<ScoreMetric::kLargestMatchSet, ScoreMetric::kLetterValue, true>(lookup, optimalWordIndices);
+
+    std::vector<NumberWord> alternatives;
+    for (size_t i = 1; i < optimalWordIndices.size(); ++i)
+    {
+        alternatives.push_back(mContext->GetTestWords().at(optimalWordIndices[i]));
+    }
+    if (!alternatives.empty())
+    {
+        std::string textForWord;
+        printf("\n\n ALTS");
+        PrintWordList(textForWord, alternatives, 12, false);
+    }
+    return mContext->GetTestWords().at(optimalWordIndices.front());
+}
+
+const NumberWord NumWordB::NumberWordStrategy::FindOpeningBookGuess() const
+{
+    if ((mOpeningBook != nullptr) && (mContext->GetSourceHash() == mOpeningBookSourceHash))
+    {
+        const NumberWord guess = mOpeningBook->FindGuess(mGuessHistory.data(), mGuessHistory.size());
+        if (guess != kInvalidNumberWord)
         {
-            return NumberWord::LookupNumberWord("zarfs");
+            return guess;
         }
     }
     return FindOptimalPatternMatch();
@@ -393,10 +1327,10 @@ void NumWordB::NumberWordStrategy::PrintWord(const size_t currentStep, const Num
     printf("\n%zu - %s", currentStep, mTextForWord.c_str());
 }
 
-void NumWordB::NumberWordStrategy::PrintWord(const size_t currentStep, const NumberWord& word, const uint16_t results)
+void NumWordB::NumberWordStrategy::PrintWord(const size_t currentStep, const NumberWord& word, const MatchPattern results)
 {
     word.ConvertToString(mTextForWord);
-    printf("\n%zu - %s %hu", currentStep, mTextForWord.c_str(), results);
+    printf("\n%zu - %s %hu", currentStep, mTextForWord.c_str(), ConvertToLegacyMatchPattern(results));
 }
 
 void NumWordB::NumberWordStrategy::PrintPossibilities()
@@ -410,11 +1344,13 @@ NumberWord NumWordB::NumberWordStrategy::GetOptimalWordFromStrategy(StepStrategy
     {
         case StepStrategy::kOptimalPatternMatch: return FindOptimalPatternMatch();
         case StepStrategy::kOptimalPatternMatchWithAlternatives: return FindOptimalPatternMatchWithAlternatives();
-        case StepStrategy::kSpecialWord1: return mSpecialWord1;
-        case StepStrategy::kSpecialWord2: return mSpecialWord2;
+        case StepStrategy::kSpecialWord1: return mContext->GetConfiguration().mSpecialWord1;
+        case StepStrategy::kSpecialWord2: return mContext->GetConfiguration().mSpecialWord2;
         case StepStrategy::kUseInputWord: return mCurrentInputWord;
         case StepStrategy::kTakeFirstEntry: return mRemainingPossibilities.at(0);
-        case StepStrategy::kSuperSpecialLogicIGuess: return SuperSpecialLogicForFindingOptimalWordIGuess();
+        case StepStrategy::kOpeningBook: return FindOpeningBookGuess();
+        case StepStrategy::kMaxEntropy: return FindBestScoredTestWord<ScoreMetric::kSumOfNLog2N, ScoreMetric::kNone>();
+        case StepStrategy::kMinExpectedSize: return FindBestScoredTestWord<ScoreMetric::kSumOfSquares, ScoreMetric::kNone>();
 
         default: return kInvalidNumberWord;
     }
@@ -464,7 +1400,7 @@ void NumWordB::PrintWordList(std::string& bufferString, const std::vector<Number
 void NumWordB::COMMAND_SpecificWord(const char* const word)
 {
     const NumberWord targetWord(NumberWord::LookupNumberWord(word));
-    NumberWordStrategy strategy;
+    NumberWordStrategy strategy(Dictionary::GetDefault());
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kOptimalWordsAndRemainingPossibilities);
     strategy.TestSpecificWord(targetWord);
 }
@@ -484,28 +1420,54 @@ void NumWordB::COMMAND_FindOptimalSecondWord()
     const size_t numLimitedStarts = sizeof(charStarts) / kWordLengthPlusNullByte;
 
 
-    NumberWordStrategy strategy;
-    strategy.SetSpecificStepStrategy(2, NumberWordStrategy::StepStrategy::kUseInputWord);
-    strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kInputWord);
-    strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kNumFails);
+    // Candidates go to whichever worker is free, all sharing the fewest fails found so far. One stops as soon as it
+    // passes that, which can't change the outcome: it has lost either way, and a tie never passes it.
+    struct CandidateResult
+    {
+        uint32_t mFails = 0;
+        bool mIsDone = false;
+    };
+    std::vector<CandidateResult> results(numLimitedStarts);
+    std::atomic<uint32_t> sharedMaxFails(UINT32_MAX);
+    std::atomic<size_t> nextCandidate(0);
+    std::mutex printMutex;
+    size_t nextToPrint = 0;
 
-    uint32_t currentMaxFails = UINT32_MAX;
-    std::vector<NumberWord> minimumFailureWords;
+    NumberWordStrategy configuredStrategy(Dictionary::GetDefault());
+    configuredStrategy.SetSpecificStepStrategy(2, NumberWordStrategy::StepStrategy::kUseInputWord);
+    const auto context = std::make_shared<const SolverContext>(configuredStrategy.GetContext()->GetConfiguration(), Dictionary::GetDefault().Get2049MatchedWords(), Dictionary::GetDefault());
 
-    for (size_t i = 0; i < numLimitedStarts; ++i)
+    ThreadPool::Get().RunOnAllWorkers([&](size_t)
     {
-        const NumberWord inputWord = NumberWord::LookupNumberWord(charStarts[i]);
-        strategy.SetInputWord(inputWord);
-        const uint32_t fails = strategy.TestAllPossibilitiesUntilPassXFails(NumberWord::s2049MatchedWords, currentMaxFails);
-        if (fails < currentMaxFails)
+        NumberWordStrategy strategy(context);
+
+        for (size_t i = nextCandidate++; i < numLimitedStarts; i = nextCandidate++)
         {
-            minimumFailureWords.clear();
-            minimumFailureWords.push_back(inputWord);
-            currentMaxFails = fails;
+            strategy.SetInputWord(NumberWord::LookupNumberWord(charStarts[i]));
+            const uint32_t fails = strategy.TestAllPossibilitiesUntilPassXFails(Dictionary::GetDefault().Get2049MatchedWords(), sharedMaxFails);
+            uint32_t sharedFails = sharedMaxFails.load();
+            while ((fails < sharedFails) && !sharedMaxFails.compare_exchange_weak(sharedFails, fails))
+            {
+            }
+
+            // Printed in candidate order, each once every one ahead of it is done
+            std::lock_guard<std::mutex> lock(printMutex);
+            results[i].mFails = fails;
+            results[i].mIsDone = true;
+            for (; (nextToPrint < numLimitedStarts) && results[nextToPrint].mIsDone; ++nextToPrint)
+            {
+                printf("\n%s :  - %u Ls\n", charStarts[nextToPrint], results[nextToPrint].mFails);
+            }
         }
-        else if (fails == currentMaxFails)
+    });
+
+    const uint32_t currentMaxFails = sharedMaxFails.load();
+    std::vector<NumberWord> minimumFailureWords;
+    for (size_t i = 0; i < numLimitedStarts; ++i)
+    {
+        if (results[i].mFails == currentMaxFails)
         {
-            minimumFailureWords.push_back(inputWord);
+            minimumFailureWords.push_back(NumberWord::LookupNumberWord(charStarts[i]));
         }
     }
 
@@ -516,12 +1478,13 @@ void NumWordB::COMMAND_FindOptimalSecondWord()
 
 void NumWordB::COMMAND_ComprehensiveTestFromSetOfFirstWords()
 {
-    NumberWordStrategy strategy;
+    NumberWordStrategy strategy(Dictionary::GetDefault());
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kInputWord);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kNumFails);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kPossibilitiesProgress);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowSuccessPossibilitiesOverThree);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowFailsAtEndOfPossibilities);
+    strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowMemoStats);
 
     strategy.SetSpecificStepStrategy(1, NumberWordStrategy::StepStrategy::kUseInputWord);
 
@@ -533,18 +1496,19 @@ void NumWordB::COMMAND_ComprehensiveTestFromSetOfFirstWords()
     {
         const NumberWord word = NumberWord::LookupNumberWord(charStarts[i]);
         strategy.SetInputWord(word);
-        strategy.TestAllPossibilities(NumberWord::sAllWords);
+        strategy.TestAllPossibilities(Dictionary::GetDefault().GetAllWords());
     }
 }
 
 void NumWordB::COMMAND_ComprehensiveTestFromSetOfSecondWords()
 {
-    NumberWordStrategy strategy;
+    NumberWordStrategy strategy(Dictionary::GetDefault());
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kInputWord);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kNumFails);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kPossibilitiesProgress);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowSuccessPossibilitiesOverThree);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowFailsAtEndOfPossibilities);
+    strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowMemoStats);
 
     strategy.SetSpecificStepStrategy(2, NumberWordStrategy::StepStrategy::kUseInputWord);
 
@@ -556,40 +1520,40 @@ void NumWordB::COMMAND_ComprehensiveTestFromSetOfSecondWords()
     {
         const NumberWord word = NumberWord::LookupNumberWord(charStarts[i]);
         strategy.SetInputWord(word);
-        strategy.TestAllPossibilities(NumberWord::s2049MatchedWords);
+        strategy.TestAllPossibilities(Dictionary::GetDefault().Get2049MatchedWords());
     }
 }
 
 void NumWordB::COMMAND_ComprehensiveTest()
 {
     double possiblePatternsEachStep = std::pow(3., 5.);
-    const double threeStepAnswers = (static_cast<double>(NumberWord::sAnswerWords.size()) - possiblePatternsEachStep);
+    const double threeStepAnswers = (static_cast<double>(Dictionary::GetDefault().GetAnswerWords().size()) - possiblePatternsEachStep);
     possiblePatternsEachStep -= 1.; // Remove exact first guess
     const double minimumPossibleStepsForAllAnswers = 1. + (2. * possiblePatternsEachStep) + (3. * threeStepAnswers);
 
-    printf("Idealized Perfect Average Steps Score: %.4f\n\n", minimumPossibleStepsForAllAnswers / static_cast<double>(NumberWord::sAnswerWords.size()));
+    printf("Idealized Perfect Average Steps Score: %.4f\n\n", minimumPossibleStepsForAllAnswers / static_cast<double>(Dictionary::GetDefault().GetAnswerWords().size()));
 
-    NumberWordStrategy strategy;
+    NumberWordStrategy strategy(Dictionary::GetDefault());
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kPossibilitiesProgress);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowSuccessPossibilitiesOverThree);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowFailsAtEndOfPossibilities);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowAverageStepsToSolve);
 
-    strategy.TestAllPossibilities(NumberWord::sAnswerWords);
+    strategy.TestAllPossibilities(Dictionary::GetDefault().GetAnswerWords());
 }
 
 void NumWordB::COMMAND_ComprehensiveTest2049WordsOnly()
 {
-    NumberWordStrategy strategy;
+    NumberWordStrategy strategy(Dictionary::GetDefault());
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kPossibilitiesProgress);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kShowFailsAtEndOfPossibilities);
 
-    strategy.TestAllPossibilities(NumberWord::s2049MatchedWords);
+    strategy.TestAllPossibilities(Dictionary::GetDefault().Get2049MatchedWords());
 }
 
 void NumWordB::COMMAND_IsThereAnyOptimalWordForDouble2049()
 {
-    NumberWordStrategy strategy;
+    NumberWordStrategy strategy(Dictionary::GetDefault());
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kInputWord);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kNumFails);
 
@@ -606,11 +1570,11 @@ void NumWordB::COMMAND_IsThereAnyOptimalWordForDouble2049()
         double2049Words.push_back(word);
     }
     strategy.SetStartingStep(3);
+    strategy.SetSpecificStepStrategy(3, NumberWordStrategy::StepStrategy::kUseInputWord);
 
-    for (const NumberWord& word : NumberWord::sAllWords)
+    for (const NumberWord& word : Dictionary::GetDefault().GetAllWords())
     {
         strategy.SetInputWord(word);
-        strategy.SetSpecificStepStrategy(3, NumberWordStrategy::StepStrategy::kUseInputWord);
         if (strategy.TestAllPossibilities(double2049Words) == 0)
         {
             std::string textForWord;
@@ -625,7 +1589,7 @@ void NumWordB::COMMAND_SpecificStartSpecificWord(const char* const start, const
 {
     const NumberWord startWord(NumberWord::LookupNumberWord(start));
     const NumberWord targetWord(NumberWord::LookupNumberWord(word));
-    NumberWordStrategy strategy;
+    NumberWordStrategy strategy(Dictionary::GetDefault());
     strategy.SetSpecialWord1(startWord);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kOptimalWordsAndRemainingPossibilities);
     strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kPrintPatternMatchAlternatives);
@@ -663,7 +1627,7 @@ void NumWordB::COMMAND_DisplayFarRemovedLetterCombinations()
     uint8_t farRemovedVars[maxRemovedVarValue + 1] = { 0 };
     std::string textForWord;
 
-    for (const NumberWord& word : NumberWord::sAllWords)
+    for (const NumberWord& word : Dictionary::GetDefault().GetAllWords())
     {
         word.ConvertToString(textForWord);
         for (size_t x = 0; x < kWordLength; ++x)
@@ -729,39 +1693,153 @@ void NumWordB::COMMAND_DisplayFarRemovedLetterCombinations()
 
 void NumWordB::COMMAND_FindFewestStepsOpeningWord(uint64_t startingIndex, uint64_t untilIndex)
 {
-    NumberWordStrategy strategy;
-    strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kInputWord);
-    strategy.AddPrintBehavior(NumberWordStrategy::PrintBehavior::kPossibilitiesProgress);
+    // Picks up from the journal of earlier runs, so a range can be split over runs or resumed after a crash
+    OpenerSweep sweep(kOpenerSweepJournalFileName, Dictionary::GetDefault());
+    sweep.LoadJournal();
+    sweep.Run(static_cast<size_t>(startingIndex), static_cast<size_t>(untilIndex), ThreadPool::Get());
+    sweep.PrintRanking(10);
+}
 
-    strategy.SetSpecificStepStrategy(1, NumberWordStrategy::StepStrategy::kUseInputWord);
+void NumWordB::COMMAND_RankJournaledOpeningWords()
+{
+    OpenerSweep sweep(kOpenerSweepJournalFileName, Dictionary::GetDefault());
+    sweep.LoadJournal();
+    sweep.PrintRanking(50);
+}
 
-    double fewestAverageSteps = 100.;
-    NumberWord fewestStepsWord = kInvalidNumberWord;
-    for (size_t i = startingIndex; (i <= untilIndex) && (i < NumberWord::sAllWords.size()); ++i)
+void NumWordB::COMMAND_FindExactFewestSteps(const char* const opener, uint64_t guessBreadth)
+{
+    const NumberWord openerWord(NumberWord::LookupNumberWord(opener));
+    if (openerWord.mIndex == kInvalidNumberWord.mIndex)
     {
-        const NumberWord& word = NumberWord::sAllWords.at(i);
+        printf("%s is not in the dictionary\n", opener);
+        return;
+    }
 
-        strategy.SetInputWord(word);
-        strategy.TestAllPossibilities(NumberWord::sAnswerWords);
-        if (strategy.GetAverageStepsToSolve() < fewestAverageSteps)
+    // Journaled like fsw, so the optimum of every opener solved sits next to what the greedy strategies made of it
+    ExactSolver solver(static_cast<size_t>(guessBreadth), Dictionary::GetDefault());
+    OpenerSweep sweep(kExactSolverJournalFileName, solver.GetConfigurationHash(), Dictionary::GetDefault());
+    sweep.LoadJournal();
+    if (sweep.IsJournaled(openerWord.mIndex))
+    {
+        printf("%s already solved in %s\n", opener, kExactSolverJournalFileName);
+    }
+    else
+    {
+        const auto startTime = std::chrono::steady_clock::now();
+        const OpenerResult result = solver.Solve(openerWord);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+        std::string textForWord;
+        openerWord.ConvertToString(textForWord);
+        printf("\n%s : Avg Steps %.4f - %u Ls -", textForWord.c_str(), static_cast<double>(result.mTotalSteps) / static_cast<double>(sweep.GetNumTargets()), result.mFails);
+        for (size_t steps = 1; steps < result.mTargetsBySteps.size(); ++steps)
         {
-            fewestAverageSteps = strategy.GetAverageStepsToSolve();
-            fewestStepsWord = word;
+            printf(" %u", result.mTargetsBySteps[steps]);
         }
+        printf("\n%s in %.2fs, %" PRIu64 " sets searched, %" PRIu64 " table hits, %zu sets in the table\n",
+            solver.IsExhaustive() ? "Optimal over every test word" : "Best over the lowest bound test words of each set", elapsed.count(),
+            solver.GetNumSetsSearched(), solver.GetNumTableHits(), solver.GetNumTableEntries());
+        sweep.Record(result);
     }
+    sweep.PrintRanking(10);
+}
 
-    printf("\nLowest average steps at: %.4f\n", fewestAverageSteps);
-    std::string textForWord;
-    fewestStepsWord.ConvertToString(textForWord);
-    printf(" %s", textForWord.c_str());
+void NumWordB::COMMAND_CompileOpeningBook(const char* const opener, uint64_t guessBreadth)
+{
+    const NumberWord openerWord(NumberWord::LookupNumberWord(opener));
+    if (openerWord.mIndex == kInvalidNumberWord.mIndex)
+    {
+        printf("%s is not in the dictionary\n", opener);
+        return;
+    }
+
+    // The configuration PlayWordle and PlayQuordle start from, but for the opener
+    const auto startTime = std::chrono::steady_clock::now();
+    NumberWordStrategy strategy(Dictionary::GetDefault());
+    strategy.SetSpecialWord2(openerWord);
+    OpeningBook book;
+    strategy.CompileOpeningBook(Dictionary::GetDefault().GetAllWords(), static_cast<size_t>(guessBreadth), book);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    NumberWordStrategy searchingStrategy(Dictionary::GetDefault());
+    searchingStrategy.SetSpecialWord2(openerWord);
+    searchingStrategy.TestAllPossibilities(Dictionary::GetDefault().GetAllWords());
+    strategy.UseOpeningBook(book);
+    strategy.TestAllPossibilities(Dictionary::GetDefault().GetAllWords());
+    printf("Compiled %zu guesses in %.2fs, avg steps %.4f with the book, %.4f without", book.GetNumEntries(), elapsed.count(),
+        strategy.GetAverageStepsToSolve(), searchingStrategy.GetAverageStepsToSolve());
+    if (!book.Save(kOpeningBookFileName))
+    {
+        printf(", but could not save to %s\n", kOpeningBookFileName);
+        return;
+    }
+    printf(", saved to %s\n", kOpeningBookFileName);
+
+    NumberWordStrategy playStrategy(Dictionary::GetDefault());
+    if (!playStrategy.UseOpeningBook(book))
+    {
+        printf("Wordle and Quordle start from another opener, and will not use it\n");
+    }
+    else
+    {
+        printf("Compile the decision tree again for Wordle and Quordle to follow it\n");
+    }
+}
+
+void NumWordB::COMMAND_CompileDecisionTree()
+{
+    // The same configuration PlayWordle and PlayQuordle start from
+    const auto startTime = std::chrono::steady_clock::now();
+    NumberWordStrategy strategy(Dictionary::GetDefault());
+    OpeningBook book;
+    if (book.Load(kOpeningBookFileName) && strategy.UseOpeningBook(book))
+    {
+        printf("Following the opening book from %s\n", kOpeningBookFileName);
+    }
+    DecisionTree tree;
+    strategy.CompileDecisionTree(Dictionary::GetDefault().GetAllWords(), tree);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    printf("Compiled %zu guesses for %zu targets in %.2fs, avg steps %.4f", tree.GetNumNodes(), Dictionary::GetDefault().GetAllWords().size(), elapsed.count(), strategy.GetAverageStepsToSolve());
+    if (tree.Save(kDecisionTreeFileName))
+    {
+        printf(", saved to %s\n", kDecisionTreeFileName);
+    }
+    else
+    {
+        printf(", but could not save to %s\n", kDecisionTreeFileName);
+    }
 }
 
 void NumWordB::COMMAND_PlayWordle()
 {
-    NumberWordStrategy strategy;
+    COMMAND_PlayWordleWithTimeBudget(0);
+}
+
+void NumWordB::COMMAND_PlayWordleWithTimeBudget(uint64_t milliseconds)
+{
+    NumberWordStrategy strategy(Dictionary::GetDefault());
+    strategy.SetStepTimeBudget(std::chrono::milliseconds(milliseconds));
+    OpeningBook book;
+    if (book.Load(kOpeningBookFileName) && strategy.UseOpeningBook(book))
+    {
+        printf("Loaded opening book from %s\n", kOpeningBookFileName);
+    }
+    DecisionTree tree;
+    if (tree.Load(kDecisionTreeFileName, strategy.GetConfigurationHash(Dictionary::GetDefault().GetAllWords())) && strategy.UseDecisionTree(tree))
+    {
+        printf("Loaded decision tree from %s\n", kDecisionTreeFileName);
+    }
     strategy.ProceedToNextStepWithPattern(0u);
     strategy.PrintOptimalWordWithInstructions();
 
+    // With a budget only a guess the speculator already has is taken. Its searches never hold up this thread's, which
+    // get the whole pool, so each step stays within the budget.
+    GuessSpeculator speculator(1, Dictionary::GetDefault(), book, tree);
+    speculator.Start(0, strategy);
+    const bool canWaitForSpeculator = (milliseconds == 0);
+
     char c;
     std::string input;
     bool loop = true;
@@ -782,24 +1860,23 @@ void NumWordB::COMMAND_PlayWordle()
         }
         else if ((c == '\n' || c == '\r') && input.size() == kWordLength)
         {
-            uint16_t pattern = kEarmarkMatchPattern;
+            MatchPattern pattern = 0;
             for (size_t i = 0; i < kWordLength; ++i)
             {
-                if (input[i] == '1')
-                {
-                    pattern += static_cast<uint16_t>(SingleMatch::kPartial) << (i * kBitsPerMatch);
-                }
-                else if (input[i] == '2')
-                {
-                    pattern += static_cast<uint16_t>(SingleMatch::kHit) << (i * kBitsPerMatch);
-                }
+                pattern += static_cast<MatchPattern>(input[i] - '0') * kMatchPatternDigitValue[i];
             }
 
             input.clear();
+            NumberWord speculatedGuess(kInvalidNumberWord);
+            if (speculator.TakeGuess(0, pattern, canWaitForSpeculator, speculatedGuess))
+            {
+                strategy.ProvideNextGuess(pattern, speculatedGuess);
+            }
             loop = strategy.ProceedToNextStepWithPattern(pattern);
             if (loop)
             {
                 strategy.PrintOptimalWordWithInstructions();
+                speculator.Start(0, strategy);
             }
         }
     } while (loop);
@@ -809,13 +1886,35 @@ void NumWordB::COMMAND_PlayQuordle()
 {
     bool solvedStrategy[4] = { false, false, false, false };
     size_t numSolved = 0;
-    NumberWordStrategy strategy[4];
+    const Dictionary& dictionary = Dictionary::GetDefault();
+    NumberWordStrategy strategy[4] = { NumberWordStrategy(dictionary), NumberWordStrategy(dictionary), NumberWordStrategy(dictionary), NumberWordStrategy(dictionary) };
+    OpeningBook book;
+    if (book.Load(kOpeningBookFileName) && strategy[0].UseOpeningBook(book))
+    {
+        printf("Loaded opening book from %s\n", kOpeningBookFileName);
+        for (size_t i = 1; i < 4; ++i)
+        {
+            strategy[i].UseOpeningBook(book);
+        }
+    }
+    DecisionTree tree;
+    if (tree.Load(kDecisionTreeFileName, strategy[0].GetConfigurationHash(Dictionary::GetDefault().GetAllWords())))
+    {
+        printf("Loaded decision tree from %s\n", kDecisionTreeFileName);
+    }
     for (size_t i = 0; i < 4; ++i)
     {
+        strategy[i].UseDecisionTree(tree);
         strategy[i].ProceedToNextStepWithPattern(0u);
     }
     strategy[0].PrintOptimalWordWithInstructions();
 
+    GuessSpeculator speculator(4, dictionary, book, tree);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        speculator.Start(i, strategy[i]);
+    }
+
     char c;
     std::string input;
     bool loop = true;
@@ -850,20 +1949,18 @@ void NumWordB::COMMAND_PlayQuordle()
                 }
                 else if ((c == '\n' || c == '\r') && input.size() == kWordLength)
                 {
-                    uint16_t pattern = kEarmarkMatchPattern;
+                    MatchPattern pattern = 0;
                     for (size_t i = 0; i < kWordLength; ++i)
                     {
-                        if (input[i] == '1')
-                        {
-                            pattern += static_cast<uint16_t>(SingleMatch::kPartial) << (i * kBitsPerMatch);
-                        }
-                        else if (input[i] == '2')
-                        {
-                            pattern += static_cast<uint16_t>(SingleMatch::kHit) << (i * kBitsPerMatch);
-                        }
+                        pattern += static_cast<MatchPattern>(input[i] - '0') * kMatchPatternDigitValue[i];
                     }
 
                     input.clear();
+                    NumberWord speculatedGuess(kInvalidNumberWord);
+                    if (speculator.TakeGuess(i, pattern, true, speculatedGuess))
+                    {
+                        strategy[i].ProvideNextGuess(pattern, speculatedGuess);
+                    }
                     const bool allMatch = !strategy[i].ProceedToNextStepWithPattern(pattern);
                     if (allMatch)
                     {
@@ -894,9 +1991,16 @@ void NumWordB::COMMAND_PlayQuordle()
             NumberWord idealNextInputWord = strategy[idealIndex].GetCurrentInputWord();
             for (size_t i = 0; i < 4; ++i)
             {
-                strategy[idealIndex].SetInputWord(idealNextInputWord);
+                strategy[i].SetInputWord(idealNextInputWord);
             }
             strategy[idealIndex].PrintOptimalWordWithInstructions();
+            for (size_t i = 0; i < 4; ++i)
+            {
+                if (!solvedStrategy[i])
+                {
+                    speculator.Start(i, strategy[i]);
+                }
+            }
         }
 
     } while (loop);
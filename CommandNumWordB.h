@@ -1,29 +1,40 @@
 #pragma once
 #include "stdafx.h"
 #include "NumWords.h"
+#include "PossibilitySet.h"
+#include "DecisionTree.h"
+#include "OpeningBook.h"
+#include "StepArena.h"
+#include "SolverContext.h"
 
 namespace NumWordB
 {
-const size_t kMaxSteps = 6;
+const char* const kDecisionTreeFileName = "DecisionTree.bin";
+const char* const kOpeningBookFileName = "OpeningBook.bin";
 
 void PrintWordList(std::string& bufferString, const std::vector<NumberWord>& wordList, const uint32_t maxLines = 4, const bool hasEndingNewLine = true);
 
 
+// What a test word can be scored by, lower always being better. The histogram metrics score the sets of possibilities
+// each match pattern would leave, kLetterValue prefers test words with a higher GetLetterValue.
+enum class ScoreMetric : uint8_t
+{
+    kNone,
+    kLargestMatchSet,
+    kSumOfNLog2N,
+    kSumOfSquares,
+    kLetterValue
+};
+
 // KEY STRATEGY TOOLS
+// One game at a time, and the scratch its searches reuse, over a SolverContext that may be shared with strategies on
+// other threads. Configuring a strategy gives it a context of its own with the change, any other sharing the one
+// before keeps it as it was.
 class NumberWordStrategy
 {
 public:
-    enum class StepStrategy : uint8_t
-    {
-        kOptimalPatternMatch,
-        kOptimalPatternMatchWithAlternatives,
-        kSpecialWord1, // stowp
-        kSpecialWord2, // trace
-        kUseInputWord,
-        kTakeFirstEntry,
-        kSuperSpecialLogicIGuess
-    };
-    enum class PrintBehavior : uint8_t
+    using StepStrategy = NumWordB::StepStrategy;
+    enum class PrintBehavior : uint16_t
     {
         kNone = 0,
         kOptimalWordsAndRemainingPossibilities = 1 << 0,
@@ -33,28 +44,42 @@ public:
         kShowSuccessPossibilitiesOverThree = 1 << 4,
         kNumFails = 1 << 5,
         kPrintPatternMatchAlternatives = 1 << 6,
-        kShowAverageStepsToSolve = 1 << 7
+        kShowAverageStepsToSolve = 1 << 7,
+        kShowMemoStats = 1 << 8
     };
-    const StepStrategy kDefaultStrategies[kMaxSteps]
-    {
-        StepStrategy::kSpecialWord2,
-        StepStrategy::kOptimalPatternMatch,
-        StepStrategy::kOptimalPatternMatch,
-        StepStrategy::kOptimalPatternMatch,
-        StepStrategy::kOptimalPatternMatch,
-        StepStrategy::kTakeFirstEntry
-    };
-    const StepStrategy kStrategyPostMax = StepStrategy::kOptimalPatternMatch;
-    
-    NumberWordStrategy();
+
+    // The default configuration, over all of dictionary's words, which it also guesses from
+    explicit NumberWordStrategy(const Dictionary& dictionary);
+    explicit NumberWordStrategy(std::shared_ptr<const SolverContext> context);
     ~NumberWordStrategy() = default;
 
     size_t TestSpecificWord(const NumberWord& targetWord);
     uint32_t TestAllPossibilities(const std::vector<NumberWord>& allPossibilities);
     uint32_t TestAllPossibilitiesUntilPassXFails(const std::vector<NumberWord>& allPossibilities, uint32_t xFails);
-    bool ProceedToNextStepWithPattern(uint16_t pattern);
+    // Same, against a bound other threads may lower meanwhile. Solving stops as soon as the fails pass it, and the
+    // result is then just past the bound, so whether it beats or ties other candidates is still exact.
+    uint32_t TestAllPossibilitiesUntilPassXFails(const std::vector<NumberWord>& allPossibilities, const std::atomic<uint32_t>& xFails);
+    void CompileDecisionTree(const std::vector<NumberWord>& allPossibilities, DecisionTree& outTree);
+    bool UseDecisionTree(const DecisionTree& tree);
+    // Steps 2 and 3 go to kOpeningBook, and each guess for them is the one of guessBreadth test words, those with the
+    // smallest largest match set, whose game played out over every target its step leaves takes the fewest fails,
+    // then the fewest steps. The fallback's own guess is always among them and keeps ties, so following the book is
+    // never worse than searching. The sets are searched in parallel. 0 plays out every test word.
+    void CompileOpeningBook(const std::vector<NumberWord>& allPossibilities, size_t guessBreadth, OpeningBook& outBook);
+    // Switches steps 2 and 3 to kOpeningBook, if the book was compiled for the configuration that makes
+    bool UseOpeningBook(const OpeningBook& book);
+    uint64_t GetConfigurationHash(const std::vector<NumberWord>& allPossibilities) const;
+    bool ProceedToNextStepWithPattern(MatchPattern pattern);
+    // The guess the next ProceedToNextStepWithPattern would come to for pattern, worked out ahead of time by a strategy
+    // configured the same, so that it needn't search. Any other pattern is searched as usual.
+    void ProvideNextGuess(MatchPattern pattern, const NumberWord& guess);
+    // Back to before the first guess, ProceedToNextStepWithPattern then starts a new game
+    void Restart() { mCurrentStep = 0; }
     void PrintOptimalWordWithInstructions();
 
+    const std::shared_ptr<const SolverContext>& GetContext() const { return mContext; }
+    // Ends any game under way, what the memo holds stays good under any context
+    void UseContext(std::shared_ptr<const SolverContext> context);
     void SetStrategy(StepStrategy stepStrategyList[kMaxSteps]);
     void SetSpecificStepStrategy(size_t step, StepStrategy stepStrategy);
     void SetInputWord(const NumberWord& inputWord);
@@ -62,41 +87,139 @@ public:
     void SetSpecialWord2(const NumberWord& specialWord2);
     void AddPrintBehavior(PrintBehavior printBehavior);
     void SetStartingStep(size_t step);
+    // Searches made by ProceedToNextStepWithPattern score the most promising test words first, and once the budget
+    // runs out go with the best found so far. Zero, the default, always searches to the end.
+    void SetStepTimeBudget(std::chrono::milliseconds stepTimeBudget) { mStepTimeBudget = stepTimeBudget; }
+    // Once isCancelled is set, searches stop before their next chunk of test words, and what they found is treated as
+    // cut short. nullptr, the default, never cancels.
+    void SetCancelFlag(const std::atomic<bool>* isCancelled) { mIsCancelled = isCancelled; }
+    // Whether ProceedToNextStepWithPattern's guess is known to be the best by its step's strategy, false only when the
+    // time budget or the cancel flag cut the search short
+    bool IsCurrentInputWordProvenOptimal() const { return mIsCurrentInputWordProvenOptimal; }
 
     double GetAverageStepsToSolve() const { return mAverageStepsToSolve; }
+    // [steps] = number of targets the last TestAllPossibilities solved in that many steps
+    const std::vector<uint32_t>& GetTargetsBySteps() const { return mTargetsBySteps; }
+    size_t GetNumMemoHits() const { return mMemoHits; }
+    size_t GetNumMemoMisses() const { return mMemoMisses; }
+    size_t GetNumMemoEntries() const { return mMemo.size(); }
     size_t GetNumRemainingPossibilities() const { return mRemainingPossibilities.size(); }
+    const std::vector<NumberWord>& GetRemainingPossibilities() const { return mRemainingPossibilities; }
+    // (kWordList index << 8) | pattern of every guess ProceedToNextStepWithPattern was given the pattern of
+    const std::vector<uint32_t>& GetGuessHistory() const { return mGuessHistory; }
+    // Test words the searches could have scored, and those left to score once equivalent guesses were pruned
+    size_t GetNumTestWordsConsidered() const { return mNumTestWordsConsidered; }
+    size_t GetNumTestWordsScored() const { return mNumTestWordsScored; }
+    double GetPruningRatio() const;
     NumberWord GetCurrentInputWord() const { return mCurrentInputWord; }
 
 private:
-    void PairDownSpecificPossibilities(uint16_t sourceMatch, const NumberWord& entryWord, std::vector<NumberWord>& possibilities) const;
-    void PairDownRemainingPossibilities(uint16_t sourceMatch, const NumberWord& entryWord);
+    void SetRemainingPossibilitiesSource(const std::vector<NumberWord>& source);
+    void Reconfigure(const SolverConfiguration& configuration);
+    void ResetRemainingPossibilities();
+    void PairDownRemainingPossibilitySet(MatchPattern sourceMatch, const NumberWord& entryWord);
+    void PairDownRemainingPossibilities(MatchPattern sourceMatch, const NumberWord& entryWord);
+    bool HasPassedFailBound() const { return (mFailBound != nullptr) && (mNumFails > mFailBound->load(std::memory_order_relaxed)); }
+    uint32_t SolvePartition(const std::vector<NumberWord>& allPossibilities, const uint16_t* targetPositions, size_t numTargets, std::vector<size_t>& outStepsForTarget, DecisionTree* outTree);
 
+    void SelectTestWords(bool preferHigherLetterValue, bool keepEveryWord) const;
+    void OrderTestWordsByPromise() const;
+    uint16_t FindLowestLargeSetSizeBound(const MatchPatternLookup& lookup) const;
+    // The one scoring kernel behind every search. outTestWordIndices gets the best test word by the primary metric,
+    // then the tie break, then dictionary order, followed when collecting ties by every other word with its primary
+    // score. Returns that primary score.
+    template <ScoreMetric kPrimaryMetric, ScoreMetric kTieBreakMetric, bool kCollectTies>
+    uint64_t FindBestScoredTestWords(const MatchPatternLookup& lookup, std::vector<size_t>& outTestWordIndices) const;
+    template <ScoreMetric kPrimaryMetric, ScoreMetric kTieBreakMetric>
+    const NumberWord FindBestScoredTestWord() const;
     const NumberWord FindOptimalPatternMatch() const;
     const NumberWord FindOptimalPatternMatchWithAlternatives() const;
-    const NumberWord SuperSpecialLogicForFindingOptimalWordIGuess() const;
+    const NumberWord FindOpeningBookGuess() const;
+    void SetOpeningBookSteps();
+    // The test word whose game, played out from the step the context starts at, goes best over its whole source
+    NumberWord FindGuessByPlayingOut(std::shared_ptr<const SolverContext> context, size_t guessBreadth);
 
     void PrintWord(const size_t currentStep, const NumberWord& word);
-    void PrintWord(const size_t currentStep, const NumberWord& word, const uint16_t results);
+    void PrintWord(const size_t currentStep, const NumberWord& word, const MatchPattern results);
     void PrintPossibilities();
 
     NumberWord GetOptimalWordFromStrategy(StepStrategy strategy) const;
+    bool CanMemoize(StepStrategy strategy) const;
+    const std::vector<uint32_t>& MakeMemoKey(StepStrategy strategy);
+    bool FindMemoizedWord(StepStrategy strategy, NumberWord& outWord);
+    void StoreMemoizedWord(StepStrategy strategy, const NumberWord& word);
+    void RestoreRemainingPossibilitiesFromSet();
     
     bool HasPrintBehavior(PrintBehavior printBehavior) const;
 
+    // The set is what gets narrowed each step, the vector is kept in step with it (in source order) for the searches
     std::vector<NumberWord> mRemainingPossibilities;
+    PossibilitySet mRemainingPossibilitySet;
     std::string mTextForWord;
     size_t mCurrentStep = 0;
-    size_t mStartingStep = 0;
-    StepStrategy mStepStrategies[kMaxSteps];
     PrintBehavior mPrintBehavior = PrintBehavior::kNone;
     NumberWord mCurrentInputWord = kInvalidNumberWord;
-    NumberWord mSpecialWord1 = kInvalidNumberWord;
-    NumberWord mSpecialWord2 = kInvalidNumberWord;
-    uint16_t mStepResults[kMaxSteps] = { 0 };
 
-    const std::vector<NumberWord>* mRemainingPossibilitiesSource = nullptr;
+    std::shared_ptr<const SolverContext> mContext;
+
+    // Guesses of the searching strategies, keyed by the source, the step's strategy and every (guess, pattern) since
+    // the source, which together decide the remaining possibilities. Kept for the strategy's whole lifetime.
+    std::map<std::vector<uint32_t>, NumberWord> mMemo;
+    std::vector<uint32_t> mGuessHistory;
+    size_t mMemoHits = 0;
+    size_t mMemoMisses = 0;
 
     double mAverageStepsToSolve = 0.;
+    std::vector<uint32_t> mTargetsBySteps;
+
+    // Targets failed so far by SolvePartition, and the bound past which it gives up
+    const std::atomic<uint32_t>* mFailBound = nullptr;
+    uint32_t mNumFails = 0;
+
+    // Scratch kept across steps and games, so that once the first few games have sized it, solving allocates nothing.
+    // The arena holds the target positions of each step of SolvePartition and the lookup of every search.
+    struct WorkerBest
+    {
+        uint64_t mPrimaryScore = UINT64_MAX;
+        uint64_t mTieBreakScore = UINT64_MAX;
+        size_t mTestWordIndex = SIZE_MAX;
+        std::vector<size_t> mTiedTestWordIndices;
+    };
+    mutable StepArena mStepArena;
+    mutable std::vector<WorkerBest> mWorkerBests;
+    mutable std::vector<size_t> mOptimalWordIndices;
+
+    // The test word indices each search scores, one per class of guesses that split the remaining possibilities
+    // alike. The slots hash each class to its place in the list, stamped with the search they were filled by.
+    struct TestWordClassSlot
+    {
+        uint32_t mKey = 0;
+        uint16_t mSelectedIndex = 0;
+        uint16_t mGeneration = 0;
+    };
+    mutable std::vector<uint16_t> mSelectedTestWords;
+    mutable std::vector<TestWordClassSlot> mTestWordClassSlots;
+    mutable uint16_t mTestWordClassGeneration = 0;
+    mutable size_t mNumTestWordsConsidered = 0;
+    mutable size_t mNumTestWordsScored = 0;
+    mutable std::vector<uint64_t> mTestWordPromiseKeys;
+
+    // The deadline is only set while ProceedToNextStepWithPattern searches, every other search runs to the end
+    std::chrono::milliseconds mStepTimeBudget = std::chrono::milliseconds(0);
+    std::chrono::steady_clock::time_point mStepDeadline = std::chrono::steady_clock::time_point::max();
+    mutable bool mWasSearchCutShort = false;
+    const std::atomic<bool>* mIsCancelled = nullptr;
+    bool mIsCurrentInputWordProvenOptimal = true;
+
+    NumberWord mProvidedGuess = kInvalidNumberWord;
+    MatchPattern mProvidedPattern = 0;
+    std::vector<uint32_t> mMemoKey;
+
+    const OpeningBook* mOpeningBook = nullptr;
+    uint64_t mOpeningBookSourceHash = 0; // Its guesses only hold for the source it was compiled over
+
+    const DecisionTree* mDecisionTree = nullptr;
+    uint32_t mDecisionTreeNode = DecisionTree::kNoNode;
 };
 
 // COMMANDS
@@ -110,6 +233,11 @@ void COMMAND_IsThereAnyOptimalWordForDouble2049();
 void COMMAND_SpecificStartSpecificWord(const char* const start, const char* const word);
 void COMMAND_DisplayFarRemovedLetterCombinations();
 void COMMAND_FindFewestStepsOpeningWord(uint64_t startingIndex, uint64_t untilIndex);
+void COMMAND_RankJournaledOpeningWords();
+void COMMAND_FindExactFewestSteps(const char* const opener, uint64_t guessBreadth);
+void COMMAND_CompileOpeningBook(const char* const opener, uint64_t guessBreadth);
+void COMMAND_CompileDecisionTree();
 void COMMAND_PlayWordle();
+void COMMAND_PlayWordleWithTimeBudget(uint64_t milliseconds);
 void COMMAND_PlayQuordle();
 } // namespace NumWordB
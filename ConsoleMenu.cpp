@@ -74,7 +74,8 @@ ConsoleMenuCommandI::ConsoleMenuCommandI(const char* const command, const char*
         do
         {
             const char inputModeCharacter = mDescription.at(semiColonLoc + 1);
-            const InputMode newMode = GetInputModeFromChar(inputModeCharacter);
+            // Text is only ever declared, typing it can't switch a number input over
+            const InputMode newMode = (inputModeCharacter == 't') ? InputMode::kText : GetInputModeFromChar(inputModeCharacter);
 			const size_t inputDescriptionStart = semiColonLoc + (newMode == InputMode::kInvalid ? 1 : 2);
 
             semiColonLoc = mDescription.find(';', semiColonLoc + 1);
@@ -200,6 +201,11 @@ void ConsoleMenu::AddCommand(const char* const input, const char* const descript
 	mCommands.push_back(new ConsoleMenuCommand0Num(input, description, func));
 }
 
+void ConsoleMenu::AddCommand(const char* const input, const char* const description, FuncPtrTextNum func)
+{
+    mCommands.push_back(new ConsoleMenuCommandTextNum(input, description, func));
+}
+
 void ConsoleMenu::AddSubmenu(const char* const input, ConsoleMenu& subMenu)
 {
 	mCommands.push_back(new ConsoleMenuCommandSubMenu(input, subMenu));
@@ -107,6 +107,30 @@ void ConsoleMenu::AddCommand(const char* const input, const char* const descript
 void ConsoleMenu::ConsoleMenuCommand##NUMARGS##Num::Execute() \
 { mFunc( __VA_ARGS__ ); }
 
+// A text argument followed by a number, each input declared in the description: ";tText;dNumber"
+using FuncPtrTextNum = void(*)(const char* const, uint64_t);
+class ConsoleMenuCommandTextNum : public ConsoleMenuCommandI
+{
+public:
+    ConsoleMenuCommandTextNum(const char* const command, const char* const description, FuncPtrTextNum func)
+        : ConsoleMenuCommandI(command, description)
+    {
+        mFunc = func;
+    }
+
+    virtual ~ConsoleMenuCommandTextNum() = default;
+
+    virtual void Execute() override { mFunc(mText.c_str(), mNumber); }
+    virtual size_t GetNumArgs() const override { return 2u; }
+    virtual void SetArg(size_t /*pos*/, uint64_t val) override { mNumber = val; }
+    virtual void SetArg(size_t /*pos*/, const char* const text) override { mText = text; }
+
+private:
+    FuncPtrTextNum mFunc;
+    std::string mText;
+    uint64_t mNumber = 0;
+};
+
 #define CONSOLE_MENU_TEXT_COMMAND_DECLARE(NUMARGS, ...) \
 	using FuncPtrText##NUMARGS##Num = void(*)(__VA_ARGS__); \
 	class ConsoleMenuCommandText##NUMARGS##Num : public ConsoleMenuCommandI \
@@ -164,6 +188,8 @@ public:
     CONSOLE_MENU_TEXT_COMMAND_DECLARE(3, const char* const, const char* const, const char* const);
     CONSOLE_MENU_TEXT_COMMAND_DECLARE(4, const char* const, const char* const, const char* const, const char* const);
 
+    void AddCommand(const char* const input, const char* const description, FuncPtrTextNum func);
+
     // SubMenus
     class ConsoleMenuCommandSubMenu : public ConsoleMenuCommandI
     {
@@ -0,0 +1,126 @@
+#include "DecisionTree.h"
+
+namespace
+{
+const uint32_t kDecisionTreeFileMagic = 0x54444C57; // "WLDT"
+const uint32_t kDecisionTreeFileVersion = 1;
+
+struct DecisionTreeFileHeader
+{
+    uint32_t mMagic;
+    uint32_t mVersion;
+    uint64_t mConfigurationHash;
+    uint32_t mNumNodes;
+    uint32_t mNumEdges;
+};
+} // namespace
+
+void DecisionTree::Reset(const uint64_t configurationHash)
+{
+    mFile.Close();
+    mBuiltNodes.clear();
+    mBuiltEdges.clear();
+    mConfigurationHash = configurationHash;
+    mNodes = nullptr;
+    mEdges = nullptr;
+    mNumNodes = 0;
+    mNumEdges = 0;
+}
+
+uint32_t DecisionTree::AddNode(const NumberWord& guess, const MatchPattern* const patterns, const size_t numPatterns)
+{
+    DecisionTreeNode node;
+    node.mGuessIndex = guess.mIndex;
+    node.mNumEdges = static_cast<uint16_t>(numPatterns);
+    node.mFirstEdge = static_cast<uint32_t>(mBuiltEdges.size());
+    for (size_t i = 0; i < numPatterns; ++i)
+    {
+        DecisionTreeEdge edge = {};
+        edge.mChildNode = kNoNode;
+        edge.mPattern = patterns[i];
+        mBuiltEdges.push_back(edge);
+    }
+    mBuiltNodes.push_back(node);
+
+    // Growing the vectors moves them, so the read side is pointed at them again every time
+    mNodes = mBuiltNodes.data();
+    mEdges = mBuiltEdges.data();
+    mNumNodes = mBuiltNodes.size();
+    mNumEdges = mBuiltEdges.size();
+    return static_cast<uint32_t>(mBuiltNodes.size() - 1);
+}
+
+void DecisionTree::SetChildNode(const uint32_t node, const size_t edge, const uint32_t childNode)
+{
+    mBuiltEdges.at(mBuiltNodes.at(node).mFirstEdge + edge).mChildNode = childNode;
+}
+
+bool DecisionTree::Save(const char* const path) const
+{
+    const std::string tempFileName = std::string(path) + ".tmp";
+    {
+        std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        DecisionTreeFileHeader header;
+        header.mMagic = kDecisionTreeFileMagic;
+        header.mVersion = kDecisionTreeFileVersion;
+        header.mConfigurationHash = mConfigurationHash;
+        header.mNumNodes = static_cast<uint32_t>(mNumNodes);
+        header.mNumEdges = static_cast<uint32_t>(mNumEdges);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(mNodes), mNumNodes * sizeof(DecisionTreeNode));
+        file.write(reinterpret_cast<const char*>(mEdges), mNumEdges * sizeof(DecisionTreeEdge));
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    remove(path);
+    return rename(tempFileName.c_str(), path) == 0;
+}
+
+bool DecisionTree::Load(const char* const path, const uint64_t configurationHash)
+{
+    Reset(configurationHash);
+    if (!mFile.Open(path) || (mFile.GetSize() < sizeof(DecisionTreeFileHeader)))
+    {
+        mFile.Close();
+        return false;
+    }
+
+    DecisionTreeFileHeader header;
+    memcpy(&header, mFile.GetData(), sizeof(header));
+    const size_t expectedSize = sizeof(DecisionTreeFileHeader) + (header.mNumNodes * sizeof(DecisionTreeNode)) + (header.mNumEdges * sizeof(DecisionTreeEdge));
+    if ((header.mMagic != kDecisionTreeFileMagic) || (header.mVersion != kDecisionTreeFileVersion)
+        || (header.mConfigurationHash != configurationHash) || (mFile.GetSize() != expectedSize) || (header.mNumNodes == 0))
+    {
+        mFile.Close();
+        return false;
+    }
+
+    mNodes = reinterpret_cast<const DecisionTreeNode*>(mFile.GetData() + sizeof(DecisionTreeFileHeader));
+    mEdges = reinterpret_cast<const DecisionTreeEdge*>(mFile.GetData() + sizeof(DecisionTreeFileHeader) + (header.mNumNodes * sizeof(DecisionTreeNode)));
+    mNumNodes = header.mNumNodes;
+    mNumEdges = header.mNumEdges;
+    return true;
+}
+
+NumberWord DecisionTree::GetGuess(const uint32_t node) const
+{
+    const uint16_t guessIndex = mNodes[node].mGuessIndex;
+    return NumberWord(kWordList[guessIndex], guessIndex);
+}
+
+uint32_t DecisionTree::GetChildNode(const uint32_t node, const MatchPattern pattern) const
+{
+    const DecisionTreeEdge* const firstEdge = mEdges + mNodes[node].mFirstEdge;
+    const DecisionTreeEdge* const lastEdge = firstEdge + mNodes[node].mNumEdges;
+    const DecisionTreeEdge* const edge = std::lower_bound(firstEdge, lastEdge, pattern,
+        [](const DecisionTreeEdge& e, const MatchPattern p) { return e.mPattern < p; });
+    return ((edge != lastEdge) && (edge->mPattern == pattern)) ? edge->mChildNode : kNoNode;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "MappedFile.h"
+
+// On-disk layout, after the header: every node, then every edge. A node's edges are contiguous and sorted by pattern.
+struct DecisionTreeNode
+{
+    uint16_t mGuessIndex;   // Into kWordList
+    uint16_t mNumEdges;     // 0 when the guess is the only possibility left
+    uint32_t mFirstEdge;
+};
+
+struct DecisionTreeEdge
+{
+    uint32_t mChildNode;
+    MatchPattern mPattern;
+    uint8_t mPadding[3];
+};
+
+// Every guess a strategy makes for every target of its source, compiled ahead of time. A node is a guess and its
+// edges are the patterns that guess can give, so playing along is a lookup per step instead of a search.
+class DecisionTree
+{
+public:
+    static const uint32_t kNoNode = UINT32_MAX;
+    static const uint32_t kRootNode = 0;
+
+    DecisionTree() = default;
+    DecisionTree(const DecisionTree&) = delete;
+    DecisionTree& operator=(const DecisionTree&) = delete;
+
+    // Building
+    void Reset(uint64_t configurationHash);
+    uint32_t AddNode(const NumberWord& guess, const MatchPattern* const patterns, size_t numPatterns);
+    void SetChildNode(uint32_t node, size_t edge, uint32_t childNode);
+    bool Save(const char* const path) const;
+
+    // Maps a saved tree, which must have been compiled from a strategy with the given configuration
+    bool Load(const char* const path, uint64_t configurationHash);
+
+    bool IsEmpty() const { return mNumNodes == 0; }
+    size_t GetNumNodes() const { return mNumNodes; }
+    uint64_t GetConfigurationHash() const { return mConfigurationHash; }
+    NumberWord GetGuess(uint32_t node) const;
+    // kNoNode if the guess at node never gives pattern for any target of the source
+    uint32_t GetChildNode(uint32_t node, MatchPattern pattern) const;
+
+private:
+    uint64_t mConfigurationHash = 0;
+    const DecisionTreeNode* mNodes = nullptr;
+    const DecisionTreeEdge* mEdges = nullptr;
+    size_t mNumNodes = 0;
+    size_t mNumEdges = 0;
+
+    std::vector<DecisionTreeNode> mBuiltNodes;
+    std::vector<DecisionTreeEdge> mBuiltEdges;
+    ReadOnlyMappedFile mFile;
+};
@@ -0,0 +1,62 @@
+#include "Dictionary.h"
+
+Dictionary::Dictionary()
+    : Dictionary(kAnswerWords, kNumOfAnswerWords)
+{
+}
+
+Dictionary::Dictionary(const char (*answerWords)[kWordLengthPlusNullByte], const size_t numAnswerWords)
+    : mSharedSubsets(GetSharedSubsets())
+{
+    AddWords(mAnswers, answerWords, numAnswerWords);
+}
+
+Dictionary& Dictionary::GetDefault()
+{
+    static Dictionary sDefault;
+    return sDefault;
+}
+
+const Dictionary::Subset* Dictionary::GetSharedSubsets()
+{
+    static const std::vector<Subset> sSharedSubsets = []()
+    {
+        std::vector<Subset> subsets(static_cast<size_t>(WordSubset::kNumSubsets));
+        Subset& allWords = subsets[static_cast<size_t>(WordSubset::kAllWords)];
+        Subset& smallSetOfWords = subsets[static_cast<size_t>(WordSubset::kSmallSetOfWords)];
+        allWords.mWords.reserve(kNumWords);
+        for (size_t i = 0; i < kNumWords; ++i)
+        {
+            const NumberWord word(kWordList[i], static_cast<uint16_t>(i));
+            allWords.mWords.push_back(word);
+            allWords.mSet.Add(word);
+            if ((i % 32) == 0)
+            {
+                smallSetOfWords.mWords.push_back(word);
+                smallSetOfWords.mSet.Add(word);
+            }
+        }
+
+        AddWords(subsets[static_cast<size_t>(WordSubset::kDifficultToEvalWords)], kDifficultToEvalWords, kNumDifficultToEvalWords);
+        AddWords(subsets[static_cast<size_t>(WordSubset::kVERYDifficultToEvalWords)], kVERYDifficultToEvalWords, kNumVERYDifficultToEvalWords);
+        AddWords(subsets[static_cast<size_t>(WordSubset::k2049MatchedWords)], kFirst2049MatchedWords, kNumFirst2049MatchedWords);
+        return subsets;
+    }();
+    return sSharedSubsets.data();
+}
+
+void Dictionary::AddWords(Subset& outSubset, const char (*words)[kWordLengthPlusNullByte], const size_t numWords)
+{
+    outSubset.mWords.reserve(numWords);
+    for (size_t i = 0; i < numWords; ++i)
+    {
+        const NumberWord word = NumberWord::LookupNumberWord(words[i]);
+        // Its index would be past the end of every PossibilitySet
+        if (word == kInvalidNumberWord)
+        {
+            throw std::invalid_argument(std::string("Not a word of kWordList: ") + words[i]);
+        }
+        outSubset.mWords.push_back(word);
+        outSubset.mSet.Add(word);
+    }
+}
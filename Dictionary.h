@@ -0,0 +1,65 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "PossibilitySet.h"
+
+enum class WordSubset : uint8_t
+{
+    kAllWords,
+    kSmallSetOfWords, // Every 32nd word, for quicker runs
+    kAnswerWords,
+    kDifficultToEvalWords,
+    kVERYDifficultToEvalWords,
+    k2049MatchedWords,
+    kNumSubsets
+};
+
+// The word lists solving works over, all of them subsets of kWordList. The packed value of each word is held once by
+// NumberWord::sWordListValues, and every subset is built once up front as a list of words in its own order and as a
+// PossibilitySet. Only the answers differ between dictionaries, every other subset is built once for the whole program
+// and shared by all of them. Nothing is rebuilt afterwards, so any number of dictionaries can coexist, each shared by
+// the threads sweeping it.
+class Dictionary
+{
+public:
+    // The answers, and every other subset, of Words.h
+    Dictionary();
+    // The same, with answerWords as the answers instead. Throws std::invalid_argument if one isn't in kWordList.
+    Dictionary(const char (*answerWords)[kWordLengthPlusNullByte], size_t numAnswerWords);
+
+    Dictionary(const Dictionary&) = delete;
+    Dictionary& operator=(const Dictionary&) = delete;
+
+    // The one the menu commands use, built the first time it is asked for
+    static Dictionary& GetDefault();
+
+    const std::vector<NumberWord>& GetWords(const WordSubset subset) const { return GetSubset(subset).mWords; }
+    const PossibilitySet& GetSet(const WordSubset subset) const { return GetSubset(subset).mSet; }
+
+    // The test words: every word, or only the small set while that is in use
+    const std::vector<NumberWord>& GetAllWords() const { return GetWords(mAllWordsSubset); }
+    const std::vector<NumberWord>& GetAnswerWords() const { return GetWords(WordSubset::kAnswerWords); }
+    const std::vector<NumberWord>& GetDifficultToEvalWords() const { return GetWords(WordSubset::kDifficultToEvalWords); }
+    const std::vector<NumberWord>& GetVERYDifficultToEvalWords() const { return GetWords(WordSubset::kVERYDifficultToEvalWords); }
+    const std::vector<NumberWord>& Get2049MatchedWords() const { return GetWords(WordSubset::k2049MatchedWords); }
+
+    // Only switches which subset GetAllWords views, so not while anything is solving over this dictionary
+    void UseSmallSetOfWords(bool useSmallSet) { mAllWordsSubset = useSmallSet ? WordSubset::kSmallSetOfWords : WordSubset::kAllWords; }
+
+private:
+    struct Subset
+    {
+        std::vector<NumberWord> mWords;
+        PossibilitySet mSet;
+    };
+
+    // Every subset but the answers, which are left empty there
+    static const Subset* GetSharedSubsets();
+    static void AddWords(Subset& outSubset, const char (*words)[kWordLengthPlusNullByte], size_t numWords);
+
+    const Subset& GetSubset(const WordSubset subset) const { return (subset == WordSubset::kAnswerWords) ? mAnswers : mSharedSubsets[static_cast<size_t>(subset)]; }
+
+    const Subset* mSharedSubsets;
+    Subset mAnswers;
+    WordSubset mAllWordsSubset = WordSubset::kAllWords;
+};
@@ -0,0 +1,459 @@
+#include "ExactSolver.h"
+#include "ThreadPool.h"
+
+namespace
+{
+// SplitMix64's finalizer, spreading each word index over all 64 bits before they are combined
+uint64_t MixWordIndex(const uint16_t index)
+{
+    uint64_t mixed = index + 0x9E3779B97F4A7C15ull;
+    mixed = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+    return mixed ^ (mixed >> 31);
+}
+} // namespace
+
+NumWordB::ExactSolver::ExactSolver(const size_t guessBreadth, const Dictionary& dictionary)
+    : mGuessBreadth(guessBreadth)
+    , mDictionary(dictionary)
+    , mTable(new TableShard[kNumTableShards])
+    , mNumSetsSearched(0)
+    , mNumTableHits(0)
+{
+}
+
+uint64_t NumWordB::ExactSolver::GetConfigurationHash() const
+{
+    // FNV-1a, as NumberWordStrategy::GetConfigurationHash
+    uint64_t hash = 14695981039346656037ull;
+    const auto addToHash = [&hash](const uint64_t value)
+    {
+        for (size_t i = 0; i < sizeof(value); ++i)
+        {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    addToHash(mGuessBreadth);
+    addToHash(mDictionary.GetAllWords().size());
+    addToHash(mDictionary.GetAnswerWords().size());
+    for (const NumberWord& answer : mDictionary.GetAnswerWords())
+    {
+        addToHash((static_cast<uint64_t>(answer.mIndex) << 32) | answer.mValue);
+    }
+    return hash;
+}
+
+size_t NumWordB::ExactSolver::GetNumTableEntries() const
+{
+    size_t numEntries = 0;
+    for (size_t shard = 0; shard < kNumTableShards; ++shard)
+    {
+        std::lock_guard<std::mutex> lock(mTable[shard].mMutex);
+        numEntries += mTable[shard].mEntries.size();
+    }
+    return numEntries;
+}
+
+uint32_t NumWordB::ExactSolver::GetSetLowerBound(const size_t numWords)
+{
+    // At best one word is guessed outright and the first guess tells the rest apart, so each of them takes two. With
+    // more words than patterns some have to share one, and every word sharing takes at least a third guess.
+    const uint32_t n = static_cast<uint32_t>(numWords);
+    return (n > kNumMatchPatterns) ? (3 * n - static_cast<uint32_t>(kNumMatchPatterns) - 1) : (2 * n - 1);
+}
+
+uint64_t NumWordB::ExactSolver::GetFingerprint(const uint16_t* const words, const size_t numWords)
+{
+    // Doesn't depend on the order, the same set reached under different guesses may have its words in another
+    uint64_t fingerprint = 0;
+    for (size_t i = 0; i < numWords; ++i)
+    {
+        fingerprint ^= MixWordIndex(words[i]);
+    }
+    return fingerprint;
+}
+
+bool NumWordB::ExactSolver::FindEntry(const uint64_t fingerprint, const size_t numWords, TableEntry& outEntry) const
+{
+    TableShard& shard = mTable[(fingerprint >> 32) % kNumTableShards];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    const auto found = shard.mEntries.find(fingerprint);
+    if ((found == shard.mEntries.end()) || (found->second.mNumWords != numWords))
+    {
+        return false;
+    }
+    outEntry = found->second;
+    return true;
+}
+
+void NumWordB::ExactSolver::StoreEntry(const uint64_t fingerprint, const TableEntry& entry)
+{
+    TableShard& shard = mTable[(fingerprint >> 32) % kNumTableShards];
+    std::lock_guard<std::mutex> lock(shard.mMutex);
+    TableEntry& stored = shard.mEntries[fingerprint];
+
+    // Another worker may have got further with the same set in the meantime
+    if ((stored.mNumWords == entry.mNumWords) && (stored.mIsExact || (!entry.mIsExact && (stored.mCost >= entry.mCost))))
+    {
+        return;
+    }
+    stored = entry;
+}
+
+void NumWordB::ExactSolver::GatherGuessBounds(Worker& worker, const uint16_t* const words, const size_t numWords, const uint32_t abortAtCost, const size_t depth)
+{
+    if (worker.mGuessesByDepth.size() <= depth)
+    {
+        worker.mGuessesByDepth.resize(depth + 1);
+    }
+    std::vector<GuessBound>& guesses = worker.mGuessesByDepth[depth];
+    guesses.clear();
+
+    // Test words differing only in letters none of the words have split them exactly alike, so only the first of each
+    // such class is kept, and one that can't split them at all is never worth a guess. See SelectTestWords.
+    const uint32_t kNoLetter = UINT32_MAX;
+    uint32_t presentLetters = 0;
+    uint32_t resolvedLetters[kWordLength];
+    for (size_t i = 0; i < kWordLength; ++i)
+    {
+        resolvedLetters[i] = (NumberWord::sWordListValues[words[0]] & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+    }
+    for (size_t w = 0; w < numWords; ++w)
+    {
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            const uint32_t letter = (NumberWord::sWordListValues[words[w]] & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+            presentLetters |= 1u << letter;
+            resolvedLetters[i] = (resolvedLetters[i] == letter) ? letter : kNoLetter;
+        }
+    }
+
+    const MatchPatternLookup& lookup = worker.mArena.GetLookup();
+    MatchPattern* const patterns = worker.mPatterns.data();
+    uint16_t histogram[kMatchPatternHistogramSize] = { 0 };
+    const uint32_t n = static_cast<uint32_t>(numWords);
+    for (const NumberWord& testWord : mDictionary.GetAllWords())
+    {
+        uint32_t key = 0;
+        bool canSplit = false;
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            const uint32_t letter = (testWord.mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+            if ((presentLetters & (1u << letter)) != 0)
+            {
+                key |= letter << (i * kBitsPerLetter);
+                canSplit |= (letter != resolvedLetters[i]);
+            }
+        }
+        if (!canSplit)
+        {
+            continue;
+        }
+
+        lookup.GetTestResults(testWord, patterns);
+        uint32_t numBuckets = 0;
+        uint32_t sumOfSquares = 0;
+        for (size_t i = 0; i < numWords; ++i)
+        {
+            const uint32_t count = ++histogram[patterns[i]];
+            numBuckets += (count == 1) ? 1 : 0;
+            sumOfSquares += 2 * count - 1;
+        }
+
+        // This guess for every word, then the set bound of each bucket left, 2 * size - 1 summed over them
+        const uint32_t hit = (histogram[kPerfectMatch] != 0) ? 1 : 0;
+        uint32_t lowerBound = n + 2 * (n - hit) - (numBuckets - hit);
+        const bool canDivide = (numBuckets > 1) || (hit != 0);
+        if (canDivide && (numWords > kNumMatchPatterns))
+        {
+            // Past kNumMatchPatterns words the set bound grows by one more per word
+            for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+            {
+                lowerBound += (histogram[pattern] > kNumMatchPatterns) ? (histogram[pattern] - static_cast<uint32_t>(kNumMatchPatterns)) : 0;
+            }
+        }
+        for (size_t i = 0; i < numWords; ++i)
+        {
+            histogram[patterns[i]] = 0;
+        }
+
+        if (canDivide && (lowerBound < abortAtCost))
+        {
+            guesses.push_back({ lowerBound, sumOfSquares, key, testWord.mIndex });
+        }
+    }
+
+    // The words of a class score alike, and sorting by key after the scores brings them together
+    std::sort(guesses.begin(), guesses.end(), [](const GuessBound& a, const GuessBound& b)
+    {
+        if (a.mLowerBound != b.mLowerBound)
+        {
+            return a.mLowerBound < b.mLowerBound;
+        }
+        if (a.mSumOfSquares != b.mSumOfSquares)
+        {
+            return a.mSumOfSquares < b.mSumOfSquares;
+        }
+        if (a.mClassKey != b.mClassKey)
+        {
+            return a.mClassKey < b.mClassKey;
+        }
+        return a.mGuessIndex < b.mGuessIndex;
+    });
+    guesses.erase(std::unique(guesses.begin(), guesses.end(), [](const GuessBound& a, const GuessBound& b) { return a.mClassKey == b.mClassKey; }), guesses.end());
+
+    if ((mGuessBreadth != 0) && (guesses.size() > mGuessBreadth))
+    {
+        guesses.resize(mGuessBreadth);
+    }
+}
+
+uint32_t NumWordB::ExactSolver::SolveSet(Worker& worker, const uint16_t* const words, const size_t numWords, const uint32_t abortAtCost, const size_t depth)
+{
+    // Guessing either of two words finds the other with the next guess
+    if (numWords <= 2)
+    {
+        return static_cast<uint32_t>(2 * numWords - 1);
+    }
+
+    uint32_t lowerBound = GetSetLowerBound(numWords);
+    if (lowerBound >= abortAtCost)
+    {
+        return lowerBound;
+    }
+
+    const uint64_t fingerprint = GetFingerprint(words, numWords);
+    TableEntry entry;
+    if (FindEntry(fingerprint, numWords, entry))
+    {
+        mNumTableHits.fetch_add(1, std::memory_order_relaxed);
+        if (entry.mIsExact)
+        {
+            return entry.mCost;
+        }
+        lowerBound = std::max(lowerBound, entry.mCost);
+        if (lowerBound >= abortAtCost)
+        {
+            return lowerBound;
+        }
+    }
+    mNumSetsSearched.fetch_add(1, std::memory_order_relaxed);
+
+    entry = TableEntry();
+    entry.mNumWords = static_cast<uint16_t>(numWords);
+
+    MatchPatternLookup& lookup = worker.mArena.GetLookup();
+    lookup.Assign(words, numWords);
+
+    // One of the words telling all the others apart reaches the set bound, which no test word can beat. Checking for
+    // that first is far cheaper than bounding every test word.
+    if (numWords < kNumMatchPatterns)
+    {
+        MatchPattern* const patterns = worker.mPatterns.data();
+        for (size_t w = 0; w < numWords; ++w)
+        {
+            lookup.GetTestResults(NumberWord::GetDictionaryWord(words[w]), patterns);
+            uint64_t isPatternSeen[(kMatchPatternHistogramSize + 63) / 64] = { 0 };
+            size_t i = 0;
+            for (; i < numWords; ++i)
+            {
+                const uint64_t bit = 1ull << (patterns[i] & 63);
+                if ((isPatternSeen[patterns[i] >> 6] & bit) != 0)
+                {
+                    break;
+                }
+                isPatternSeen[patterns[i] >> 6] |= bit;
+            }
+            if (i == numWords)
+            {
+                entry.mCost = GetSetLowerBound(numWords);
+                entry.mBestGuess = words[w];
+                entry.mIsExact = true;
+                StoreEntry(fingerprint, entry);
+                return entry.mCost;
+            }
+        }
+    }
+
+    GatherGuessBounds(worker, words, numWords, abortAtCost, depth);
+
+    // Children searching deeper may grow mGuessesByDepth, so this depth's guesses are looked up again every time
+    uint16_t* const bucketed = worker.mArena.GetStep(depth);
+    PatternPartition partition;
+    MatchPattern bucketOrder[kNumMatchPatterns];
+    uint32_t bestCost = abortAtCost;
+    for (size_t g = 0; g < worker.mGuessesByDepth[depth].size(); ++g)
+    {
+        const GuessBound guess = worker.mGuessesByDepth[depth][g];
+        if (guess.mLowerBound >= bestCost)
+        {
+            break;
+        }
+
+        // Largest buckets first, they are the likeliest to push the guess past the best so far
+        partition.Assign(NumberWord::GetDictionaryWord(guess.mGuessIndex), words, numWords, bucketed);
+        size_t numBuckets = 0;
+        for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+        {
+            if (partition.GetBucketSize(static_cast<MatchPattern>(pattern)) != 0)
+            {
+                bucketOrder[numBuckets++] = static_cast<MatchPattern>(pattern);
+            }
+        }
+        std::sort(bucketOrder, bucketOrder + numBuckets, [&partition](const MatchPattern a, const MatchPattern b)
+        {
+            return partition.GetBucketSize(a) > partition.GetBucketSize(b);
+        });
+
+        // Each bucket's own bound is already in the guess's, and is swapped for what the bucket really costs
+        uint32_t cost = guess.mLowerBound;
+        for (size_t b = 0; (b < numBuckets) && (cost < bestCost); ++b)
+        {
+            const size_t bucketSize = partition.GetBucketSize(bucketOrder[b]);
+            const uint32_t bucketBound = GetSetLowerBound(bucketSize);
+            const uint32_t bucketCost = SolveSet(worker, partition.GetBucket(bucketOrder[b]), bucketSize, bestCost - (cost - bucketBound), depth + 1);
+            cost += bucketCost - bucketBound;
+        }
+
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            entry.mBestGuess = guess.mGuessIndex;
+            if (bestCost == lowerBound)
+            {
+                break;
+            }
+        }
+    }
+
+    entry.mCost = bestCost;
+    entry.mIsExact = (bestCost < abortAtCost);
+    StoreEntry(fingerprint, entry);
+    return bestCost;
+}
+
+void NumWordB::ExactSolver::CountSteps(Worker& worker, const uint16_t* const words, const size_t numWords, const uint32_t guessesSoFar, const size_t depth)
+{
+    std::vector<uint32_t>& targetsBySteps = worker.mTargetsBySteps;
+    const auto addTarget = [&targetsBySteps](const uint32_t steps)
+    {
+        if (targetsBySteps.size() <= steps)
+        {
+            targetsBySteps.resize(steps + 1, 0);
+        }
+        ++targetsBySteps[steps];
+    };
+
+    if (numWords <= 2)
+    {
+        for (uint32_t i = 1; i <= numWords; ++i)
+        {
+            addTarget(guessesSoFar + i);
+        }
+        return;
+    }
+
+    // The set was solved, but another set may have taken its place in the table since
+    const uint64_t fingerprint = GetFingerprint(words, numWords);
+    TableEntry entry;
+    if (!FindEntry(fingerprint, numWords, entry) || !entry.mIsExact)
+    {
+        SolveSet(worker, words, numWords, UINT32_MAX, depth);
+        FindEntry(fingerprint, numWords, entry);
+    }
+
+    PatternPartition partition;
+    partition.Assign(NumberWord::GetDictionaryWord(entry.mBestGuess), words, numWords, worker.mArena.GetStep(depth));
+    for (size_t pattern = 0; pattern < kNumMatchPatterns; ++pattern)
+    {
+        const size_t bucketSize = partition.GetBucketSize(static_cast<MatchPattern>(pattern));
+        if (bucketSize == 0)
+        {
+            continue;
+        }
+        if (pattern == kPerfectMatch)
+        {
+            addTarget(guessesSoFar + 1);
+            continue;
+        }
+        CountSteps(worker, partition.GetBucket(static_cast<MatchPattern>(pattern)), bucketSize, guessesSoFar + 1, depth + 1);
+    }
+}
+
+NumWordB::OpenerResult NumWordB::ExactSolver::Solve(const NumberWord& opener)
+{
+    const std::vector<NumberWord>& answers = mDictionary.GetAnswerWords();
+    std::vector<uint16_t> openerBucketed(answers.size());
+    PatternPartition openerPartition;
+    openerPartition.Assign(opener, answers, openerBucketed.data());
+
+    // Biggest first, so the longest searches start while there is still other work to spread around
+    std::vector<MatchPattern> buckets;
+    for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+    {
+        if (openerPartition.GetBucketSize(static_cast<MatchPattern>(pattern)) != 0)
+        {
+            buckets.push_back(static_cast<MatchPattern>(pattern));
+        }
+    }
+    std::sort(buckets.begin(), buckets.end(), [&openerPartition](const MatchPattern a, const MatchPattern b)
+    {
+        return openerPartition.GetBucketSize(a) > openerPartition.GetBucketSize(b);
+    });
+
+    // The buckets are independent, so each is searched whole by one worker, all of them sharing the table
+    ThreadPool& threadPool = ThreadPool::Get();
+    std::vector<std::unique_ptr<Worker>> workers(threadPool.GetNumWorkers());
+    std::mutex progressMutex;
+    size_t numBucketsSolved = 0;
+    std::string openerText;
+    opener.ConvertToString(openerText);
+    threadPool.RunWorkStealing(buckets.size(), [&](const size_t workerIndex, const size_t item)
+    {
+        if (!workers[workerIndex])
+        {
+            workers[workerIndex].reset(new Worker());
+        }
+        Worker& worker = *workers[workerIndex];
+        const uint16_t* const words = openerPartition.GetBucket(buckets[item]);
+        const size_t numWords = openerPartition.GetBucketSize(buckets[item]);
+        SolveSet(worker, words, numWords, UINT32_MAX, 0);
+        CountSteps(worker, words, numWords, 1, 0);
+
+        std::lock_guard<std::mutex> lock(progressMutex);
+        printf("\r%s: %zu of %zu sets solved", openerText.c_str(), ++numBucketsSolved, buckets.size());
+        return true;
+    });
+
+    OpenerResult result;
+    result.mOpenerIndex = opener.mIndex;
+    result.mTargetsBySteps.assign(kMaxSteps + 1, 0);
+    if (openerPartition.GetBucketSize(kPerfectMatch) != 0)
+    {
+        result.mTargetsBySteps[1] += 1;
+    }
+    for (const std::unique_ptr<Worker>& worker : workers)
+    {
+        if (!worker)
+        {
+            continue;
+        }
+        if (result.mTargetsBySteps.size() < worker->mTargetsBySteps.size())
+        {
+            result.mTargetsBySteps.resize(worker->mTargetsBySteps.size(), 0);
+        }
+        for (size_t steps = 0; steps < worker->mTargetsBySteps.size(); ++steps)
+        {
+            result.mTargetsBySteps[steps] += worker->mTargetsBySteps[steps];
+        }
+    }
+
+    for (size_t steps = 0; steps < result.mTargetsBySteps.size(); ++steps)
+    {
+        result.mTotalSteps += static_cast<uint32_t>(steps) * result.mTargetsBySteps[steps];
+        result.mFails += (steps > kMaxSteps) ? result.mTargetsBySteps[steps] : 0;
+    }
+    return result;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "StepArena.h"
+#include "Dictionary.h"
+#include "OpenerSweep.h"
+
+namespace NumWordB
+{
+const char* const kExactSolverJournalFileName = "ExactSolver.journal";
+
+// Finds, for one opener, the decision tree taking the fewest total steps to solve every answer, where the greedy
+// strategies only ever look one guess ahead. It is a depth-first branch and bound: the test words for a set of
+// possibilities are tried in order of a lower bound on the steps they can lead to, and once that bound can't beat the
+// best tree found so far, neither can any test word after it. The bounds never overestimate, so nothing cut could have
+// been better. Every set searched is kept in a table under a fingerprint of its words, with either its exact cost or
+// the cost it was proven not to beat, since the same sets turn up again under many test words. The sets the opener
+// leaves are solved in parallel.
+class ExactSolver
+{
+public:
+    // Trying only the guessBreadth test words with the lowest bounds for each set makes the search far cheaper, but
+    // the tree found is then only the best of those. 0 tries every test word, and the tree found is the optimum.
+    ExactSolver(size_t guessBreadth, const Dictionary& dictionary);
+
+    ExactSolver(const ExactSolver&) = delete;
+    ExactSolver& operator=(const ExactSolver&) = delete;
+
+    // Targets by steps over the dictionary's answers, the test words being all of its words. A target taking more than kMaxSteps
+    // counts as a fail, though the tree is free to take as many steps as it needs.
+    OpenerResult Solve(const NumberWord& opener);
+
+    bool IsExhaustive() const { return mGuessBreadth == 0; }
+    // Covers the guess breadth and the answers, the things deciding which tree is found
+    uint64_t GetConfigurationHash() const;
+
+    uint64_t GetNumSetsSearched() const { return mNumSetsSearched.load(std::memory_order_relaxed); }
+    uint64_t GetNumTableHits() const { return mNumTableHits.load(std::memory_order_relaxed); }
+    size_t GetNumTableEntries() const;
+
+private:
+    static const size_t kNumTableShards = 64;
+
+    struct TableEntry
+    {
+        uint32_t mCost = 0;         // Exact, or a bound the set's cost is at least
+        uint16_t mNumWords = 0;     // Against fingerprint collisions
+        uint16_t mBestGuess = 0;    // kWordList index, if exact
+        bool mIsExact = false;
+    };
+
+    struct TableShard
+    {
+        std::mutex mMutex;
+        std::unordered_map<uint64_t, TableEntry> mEntries; // By fingerprint
+    };
+
+    struct GuessBound
+    {
+        uint32_t mLowerBound;
+        uint32_t mSumOfSquares; // Of bucket sizes, to try the more even splits first among equal bounds
+        uint32_t mClassKey;     // The test word with the letters none of the words have left out
+        uint16_t mGuessIndex;
+    };
+
+    // Kept per worker and reused for every set it searches, buffers for each depth of the search
+    struct Worker
+    {
+        StepArena mArena;
+        std::vector<MatchPattern> mPatterns = std::vector<MatchPattern>(kNumWords);
+        std::vector<std::vector<GuessBound>> mGuessesByDepth;
+        std::vector<uint32_t> mTargetsBySteps;
+    };
+
+    static uint32_t GetSetLowerBound(size_t numWords);
+    static uint64_t GetFingerprint(const uint16_t* words, size_t numWords);
+
+    // Minimal total steps for the words, all kWordList indices, counted from this set's first guess on. A result
+    // >= abortAtCost only means the set costs at least that much.
+    uint32_t SolveSet(Worker& worker, const uint16_t* words, size_t numWords, uint32_t abortAtCost, size_t depth);
+    // Fills worker.mGuessesByDepth[depth] with the test words that could cost less than abortAtCost, lowest bound first
+    void GatherGuessBounds(Worker& worker, const uint16_t* words, size_t numWords, uint32_t abortAtCost, size_t depth);
+    // Follows the best guesses of the table to count the targets by steps into worker.mTargetsBySteps
+    void CountSteps(Worker& worker, const uint16_t* words, size_t numWords, uint32_t guessesSoFar, size_t depth);
+
+    bool FindEntry(uint64_t fingerprint, size_t numWords, TableEntry& outEntry) const;
+    void StoreEntry(uint64_t fingerprint, const TableEntry& entry);
+
+    size_t mGuessBreadth;
+    const Dictionary& mDictionary;
+    std::unique_ptr<TableShard[]> mTable;
+    std::atomic<uint64_t> mNumSetsSearched;
+    std::atomic<uint64_t> mNumTableHits;
+};
+} // namespace NumWordB
@@ -0,0 +1,165 @@
+#include "GuessSpeculator.h"
+#include "ThreadPool.h"
+
+NumWordB::GuessSpeculator::GuessSpeculator(const size_t numBoards, const Dictionary& dictionary, const OpeningBook& book, const DecisionTree& tree)
+    : mBoards(numBoards)
+{
+    for (Board& board : mBoards)
+    {
+        board.mStrategy.reset(new NumberWordStrategy(dictionary));
+        board.mStrategy->SetCancelFlag(&mIsJobCancelled);
+        board.mStrategy->UseOpeningBook(book);
+        board.mStrategy->UseDecisionTree(tree);
+    }
+    mThread = std::thread(&GuessSpeculator::WorkerLoop, this);
+}
+
+NumWordB::GuessSpeculator::~GuessSpeculator()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+        mQueue.clear();
+        mIsJobCancelled = true;
+    }
+    mJobReady.notify_all();
+    mThread.join();
+}
+
+void NumWordB::GuessSpeculator::Start(const size_t board, const NumberWordStrategy& strategy)
+{
+    const NumberWord& currentGuess = strategy.GetCurrentInputWord();
+    size_t numPossibilitiesByPattern[kMatchPatternHistogramSize] = { 0 };
+    for (const NumberWord& possibility : strategy.GetRemainingPossibilities())
+    {
+        ++numPossibilitiesByPattern[possibility.GetTestResults(currentGuess)];
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        Board& speculated = mBoards[board];
+        speculated.mGuessHistory = strategy.GetGuessHistory();
+        speculated.mCurrentGuess = currentGuess;
+        ++speculated.mGeneration;
+        CancelRunningJob(board);
+        std::fill(std::begin(speculated.mIsGuessDone), std::end(speculated.mIsGuessDone), false);
+
+        mQueue.erase(std::remove_if(mQueue.begin(), mQueue.end(), [board](const Job& job) { return job.mBoard == board; }), mQueue.end());
+        // A perfect match ends the game, there is nothing to guess after it
+        for (size_t pattern = 0; pattern < kPerfectMatch; ++pattern)
+        {
+            if (numPossibilitiesByPattern[pattern] != 0)
+            {
+                mQueue.push_back({ board, static_cast<MatchPattern>(pattern), numPossibilitiesByPattern[pattern] });
+            }
+        }
+        std::stable_sort(mQueue.begin(), mQueue.end(), [](const Job& a, const Job& b) { return a.mNumPossibilities > b.mNumPossibilities; });
+    }
+    mJobReady.notify_all();
+}
+
+bool NumWordB::GuessSpeculator::IsQueued(const size_t board, const MatchPattern pattern) const
+{
+    return std::any_of(mQueue.begin(), mQueue.end(), [board, pattern](const Job& job) { return (job.mBoard == board) && (job.mPattern == pattern); });
+}
+
+void NumWordB::GuessSpeculator::CancelRunningJob(const size_t board)
+{
+    if (mIsRunningJob && (mRunningJob.mBoard == board))
+    {
+        mIsJobCancelled = true;
+    }
+}
+
+bool NumWordB::GuessSpeculator::TakeGuess(const size_t board, const MatchPattern pattern, const bool canWait, NumberWord& outGuess)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    Board& speculated = mBoards[board];
+    const bool wasQueued = IsQueued(board, pattern);
+    mQueue.erase(std::remove_if(mQueue.begin(), mQueue.end(), [board](const Job& job) { return job.mBoard == board; }), mQueue.end());
+    if (!canWait || (mIsRunningJob && (mRunningJob.mPattern != pattern)))
+    {
+        CancelRunningJob(board);
+    }
+    if (canWait && wasQueued)
+    {
+        mQueue.insert(mQueue.begin(), { board, pattern, 0 });
+        mJobReady.notify_all();
+    }
+
+    if (canWait)
+    {
+        mJobDone.wait(lock, [this, &speculated, board, pattern]()
+        {
+            const bool isRunning = mIsRunningJob && (mRunningJob.mBoard == board) && (mRunningJob.mPattern == pattern);
+            return speculated.mIsGuessDone[pattern] || (!isRunning && !IsQueued(board, pattern));
+        });
+    }
+
+    if (!speculated.mIsGuessDone[pattern])
+    {
+        return false;
+    }
+    outGuess = NumberWord::GetDictionaryWord(speculated.mGuessIndices[pattern]);
+    return true;
+}
+
+NumberWord NumWordB::GuessSpeculator::ReplayAndGuess(Board& board, const std::vector<uint32_t>& guessHistory, const NumberWord& currentGuess, const MatchPattern pattern)
+{
+    // The same guesses and patterns the board was played with bring the strategy to the same step, each guess it
+    // searched for then long memoized
+    NumberWordStrategy& strategy = *board.mStrategy;
+    strategy.Restart();
+    strategy.ProceedToNextStepWithPattern(0u);
+    for (const uint32_t step : guessHistory)
+    {
+        if (mIsJobCancelled)
+        {
+            return kInvalidNumberWord;
+        }
+        strategy.SetInputWord(NumberWord::GetDictionaryWord(static_cast<uint16_t>(step >> 8)));
+        strategy.ProceedToNextStepWithPattern(static_cast<MatchPattern>(step & 0xFF));
+    }
+    strategy.SetInputWord(currentGuess);
+    strategy.ProceedToNextStepWithPattern(pattern);
+    return strategy.GetCurrentInputWord();
+}
+
+void NumWordB::GuessSpeculator::WorkerLoop()
+{
+    ThreadPool::KeepCallingThreadOffPool();
+    std::vector<uint32_t> guessHistory;
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mJobReady.wait(lock, [this]() { return mIsStopping || !mQueue.empty(); });
+        if (mIsStopping)
+        {
+            return;
+        }
+
+        const Job job = mQueue.front();
+        mQueue.erase(mQueue.begin());
+        Board& board = mBoards[job.mBoard];
+        const uint64_t generation = board.mGeneration;
+        guessHistory = board.mGuessHistory;
+        const NumberWord currentGuess = board.mCurrentGuess;
+        mRunningJob = job;
+        mIsRunningJob = true;
+        mIsJobCancelled = false;
+
+        // Only this thread touches the board's strategy, the lock is just for what Start and TakeGuess share
+        lock.unlock();
+        const NumberWord guess = ReplayAndGuess(board, guessHistory, currentGuess, job.mPattern);
+        lock.lock();
+
+        // A cancelled search stopped with whatever it had, which is no guess at all
+        if ((board.mGeneration == generation) && !mIsJobCancelled)
+        {
+            board.mGuessIndices[job.mPattern] = guess.mIndex;
+            board.mIsGuessDone[job.mPattern] = true;
+        }
+        mIsRunningJob = false;
+        mJobDone.notify_all();
+    }
+}
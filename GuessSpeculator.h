@@ -0,0 +1,71 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "CommandNumWordB.h"
+#include "DecisionTree.h"
+#include "OpeningBook.h"
+
+namespace NumWordB
+{
+// While the player types in a pattern, works out on a thread of its own the guess each board's strategy will come to
+// for every pattern its current guess can get, the patterns most of the remaining possibilities give first. Each board
+// is replayed on a default configured strategy of the speculator's own, as the Play commands use, whose memo keeps the
+// steps before from being searched again. Its searches run on its own thread alone, never on the ThreadPool, so the
+// main thread's searches for patterns the speculator didn't get to always have the whole pool at once. A search made
+// useless by the player's pattern, or by the speculator going away, is cancelled rather than waited out.
+class GuessSpeculator
+{
+public:
+    // Each board's strategy is made over dictionary, and given book and tree the way the Play command gives them to its
+    // own. Either may be empty.
+    GuessSpeculator(size_t numBoards, const Dictionary& dictionary, const OpeningBook& book, const DecisionTree& tree);
+    ~GuessSpeculator();
+
+    GuessSpeculator(const GuessSpeculator&) = delete;
+    GuessSpeculator& operator=(const GuessSpeculator&) = delete;
+
+    // Drops what was queued for the board, and queues every pattern the strategy's current guess can get
+    void Start(size_t board, const NumberWordStrategy& strategy);
+
+    // The guess for the pattern the player typed in, moved ahead of everything else if it wasn't worked out yet. The
+    // board's other patterns are dropped, and a search under way for one of them is cancelled. Without canWait only a
+    // guess already worked out is taken. False if there is none, and the strategy has to search for itself.
+    bool TakeGuess(size_t board, MatchPattern pattern, bool canWait, NumberWord& outGuess);
+
+private:
+    struct Job
+    {
+        size_t mBoard;
+        MatchPattern mPattern;
+        size_t mNumPossibilities;
+    };
+
+    struct Board
+    {
+        std::unique_ptr<NumberWordStrategy> mStrategy;
+        std::vector<uint32_t> mGuessHistory;
+        NumberWord mCurrentGuess = kInvalidNumberWord;
+        uint64_t mGeneration = 0;  // Bumped by every Start, so a guess worked out for the step before is dropped
+        uint16_t mGuessIndices[kNumMatchPatterns] = { 0 }; // Into kWordList
+        bool mIsGuessDone[kNumMatchPatterns] = { false };
+    };
+
+    void WorkerLoop();
+    bool IsQueued(size_t board, MatchPattern pattern) const;
+    // Must be called with mMutex held
+    void CancelRunningJob(size_t board);
+    NumberWord ReplayAndGuess(Board& board, const std::vector<uint32_t>& guessHistory, const NumberWord& currentGuess, MatchPattern pattern);
+
+    std::vector<Board> mBoards;
+    std::vector<Job> mQueue;
+    bool mIsRunningJob = false;
+    Job mRunningJob = {};
+    bool mIsStopping = false;
+    std::atomic<bool> mIsJobCancelled{ false }; // Every board's strategy stops searching once it is set
+
+    std::mutex mMutex;
+    std::condition_variable mJobReady;
+    std::condition_variable mJobDone;
+    std::thread mThread;
+};
+} // namespace NumWordB
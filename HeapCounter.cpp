@@ -0,0 +1,77 @@
+#include "HeapCounter.h"
+
+#if defined(WORDLESS_COUNT_HEAP_ALLOCATIONS)
+namespace
+{
+std::atomic<size_t> sNumHeapAllocations(0);
+
+void* CountedAllocate(const size_t size) noexcept
+{
+    sNumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc((size != 0) ? size : 1);
+}
+
+void* CountedAllocateAligned(size_t size, const std::align_val_t alignment) noexcept
+{
+    sNumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    const size_t alignmentSize = static_cast<size_t>(alignment);
+#if defined(_MSC_VER)
+    return _aligned_malloc((size != 0) ? size : 1, alignmentSize);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment
+    size = ((size + alignmentSize - 1) / alignmentSize) * alignmentSize;
+    return aligned_alloc(alignmentSize, (size != 0) ? size : alignmentSize);
+#endif
+}
+
+void FreeAligned(void* const memory) noexcept
+{
+#if defined(_MSC_VER)
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+void* ThrowIfNull(void* const memory)
+{
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+} // namespace
+
+void* operator new(const size_t size) { return ThrowIfNull(CountedAllocate(size)); }
+void* operator new[](const size_t size) { return ThrowIfNull(CountedAllocate(size)); }
+void* operator new(const size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new[](const size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size); }
+void* operator new(const size_t size, const std::align_val_t alignment) { return ThrowIfNull(CountedAllocateAligned(size, alignment)); }
+void* operator new[](const size_t size, const std::align_val_t alignment) { return ThrowIfNull(CountedAllocateAligned(size, alignment)); }
+void* operator new(const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept { return CountedAllocateAligned(size, alignment); }
+void* operator new[](const size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept { return CountedAllocateAligned(size, alignment); }
+
+void operator delete(void* const memory) noexcept { free(memory); }
+void operator delete[](void* const memory) noexcept { free(memory); }
+void operator delete(void* const memory, size_t) noexcept { free(memory); }
+void operator delete[](void* const memory, size_t) noexcept { free(memory); }
+void operator delete(void* const memory, const std::nothrow_t&) noexcept { free(memory); }
+void operator delete[](void* const memory, const std::nothrow_t&) noexcept { free(memory); }
+void operator delete(void* const memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* const memory, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void* const memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete[](void* const memory, size_t, std::align_val_t) noexcept { FreeAligned(memory); }
+void operator delete(void* const memory, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(memory); }
+void operator delete[](void* const memory, std::align_val_t, const std::nothrow_t&) noexcept { FreeAligned(memory); }
+
+size_t HeapCounter::GetNumHeapAllocations()
+{
+    return sNumHeapAllocations.load(std::memory_order_relaxed);
+}
+#else
+size_t HeapCounter::GetNumHeapAllocations()
+{
+    return 0;
+}
+#endif
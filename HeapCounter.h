@@ -0,0 +1,17 @@
+#pragma once
+#include "stdafx.h"
+
+// Counting heap allocations is instrumentation for the benchmarks. Defining WORDLESS_COUNT_HEAP_ALLOCATIONS replaces
+// every global allocation function with one that counts its calls, including the allocations made inside the standard
+// containers. That is an atomic increment per allocation, so no other build has it.
+namespace HeapCounter
+{
+#if defined(WORDLESS_COUNT_HEAP_ALLOCATIONS)
+const bool kIsCounting = true;
+#else
+const bool kIsCounting = false;
+#endif
+
+// Calls to the global operator new since startup, from every thread. Always 0 unless kIsCounting.
+size_t GetNumHeapAllocations();
+} // namespace HeapCounter
@@ -0,0 +1,63 @@
+#include "stdafx.h"
+#include "MappedFile.h"
+
+#include <windows.h>
+
+bool ReadOnlyMappedFile::Open(const char* const path)
+{
+    Close();
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mFileHandle = file;
+    mMappingHandle = mapping;
+    mData = static_cast<const uint8_t*>(view);
+    mSize = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+void ReadOnlyMappedFile::Close()
+{
+    if (mData != nullptr)
+    {
+        UnmapViewOfFile(mData);
+        mData = nullptr;
+    }
+    if (mMappingHandle != nullptr)
+    {
+        CloseHandle(mMappingHandle);
+        mMappingHandle = nullptr;
+    }
+    if (mFileHandle != nullptr)
+    {
+        CloseHandle(mFileHandle);
+        mFileHandle = nullptr;
+    }
+    mSize = 0;
+}
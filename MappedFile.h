@@ -0,0 +1,25 @@
+#pragma once
+
+// Read-only view of a whole file mapped into memory
+class ReadOnlyMappedFile
+{
+public:
+    ReadOnlyMappedFile() = default;
+    ~ReadOnlyMappedFile() { Close(); }
+
+    ReadOnlyMappedFile(const ReadOnlyMappedFile&) = delete;
+    ReadOnlyMappedFile& operator=(const ReadOnlyMappedFile&) = delete;
+
+    bool Open(const char* const path);
+    void Close();
+
+    bool IsOpen() const { return mData != nullptr; }
+    const uint8_t* GetData() const { return mData; }
+    size_t GetSize() const { return mSize; }
+
+private:
+    void* mFileHandle = nullptr;
+    void* mMappingHandle = nullptr;
+    const uint8_t* mData = nullptr;
+    size_t mSize = 0;
+};
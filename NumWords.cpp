@@ -1,52 +1,485 @@
 #include "NumWords.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
 
-uint16_t NumberWord::sMatchSetToMatchPattern[kNumWords][kNumWords] = { {0} };
-std::vector<NumberWord> NumberWord::sAllWords;
-std::vector<NumberWord> NumberWord::sAnswerWords;
-std::vector<NumberWord> NumberWord::sDifficultToEvalWords;
-std::vector<NumberWord> NumberWord::sVERYDifficultToEvalWords;
-std::vector<NumberWord> NumberWord::s2049MatchedWords;
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
-void NumberWord::Initialize()
+const MatchPattern* NumberWord::sTestMajorMatchPatterns = nullptr;
+uint16_t NumberWord::sMatchPatternColumns[kNumWords];
+size_t NumberWord::sNumMatchPatternColumns = 0;
+MatchPatternMatrixMode NumberWord::sMatchPatternMatrixMode = MatchPatternMatrixMode::kAllWords;
+std::vector<uint32_t> NumberWord::sWordListValues;
+
+void NumberWord::ComputeTestResultsBatch(const NumberWord& testWord, const uint32_t* const answerValues, const size_t numAnswers, MatchPattern* const outPatterns)
+{
+    size_t answer = 0;
+
+#if defined(__AVX2__)
+    uint32_t testLetters[kWordLength];
+    for (size_t i = 0; i < kWordLength; ++i)
+    {
+        testLetters[i] = (testWord.mValue & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
+    }
+
+    const __m256i letterMask = _mm256_set1_epi32(static_cast<int>(kLetterMatchBitmask[0]));
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i testLetterLanes[kWordLength];
+    __m256i hitValue[kWordLength];
+    __m256i partialValue[kWordLength];
+    for (size_t i = 0; i < kWordLength; ++i)
+    {
+        testLetterLanes[i] = _mm256_set1_epi32(static_cast<int>(testLetters[i]));
+        hitValue[i] = _mm256_set1_epi32(static_cast<int>(SingleMatch::kHit) * kMatchPatternDigitValue[i]);
+        partialValue[i] = _mm256_set1_epi32(static_cast<int>(SingleMatch::kPartial) * kMatchPatternDigitValue[i]);
+    }
+
+    for (; (answer + 8) <= numAnswers; answer += 8)
+    {
+        const __m256i answerLanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(answerValues + answer));
+
+        // Hits are a straight lane-wise compare per letter. Hit letters are then zeroed out of the answer,
+        // and since test letters are never 0 they can no longer be counted as partials.
+        __m256i hits[kWordLength];
+        __m256i remainingAnswerLetters[kWordLength];
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            const __m256i answerLetter = _mm256_and_si256(_mm256_srli_epi32(answerLanes, static_cast<int>(i * kBitsPerLetter)), letterMask);
+            hits[i] = _mm256_cmpeq_epi32(answerLetter, testLetterLanes[i]);
+            remainingAnswerLetters[i] = _mm256_andnot_si256(hits[i], answerLetter);
+        }
+
+        // How many unmatched copies of each test letter the answer still holds
+        __m256i letterCounts[kWordLength];
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            letterCounts[i] = zero;
+            for (size_t t = 0; t < kWordLength; ++t)
+            {
+                // Compare yields -1 per match, so subtracting counts up
+                letterCounts[i] = _mm256_sub_epi32(letterCounts[i], _mm256_cmpeq_epi32(remainingAnswerLetters[t], testLetterLanes[i]));
+            }
+        }
+
+        __m256i patterns = zero;
+        for (size_t i = 0; i < kWordLength; ++i)
+        {
+            const __m256i partial = _mm256_andnot_si256(hits[i], _mm256_cmpgt_epi32(letterCounts[i], zero));
+            patterns = _mm256_add_epi32(patterns, _mm256_and_si256(hits[i], hitValue[i]));
+            patterns = _mm256_add_epi32(patterns, _mm256_and_si256(partial, partialValue[i]));
+
+            // A partial uses up one copy of the letter for every later position testing the same letter
+            for (size_t t = i + 1; t < kWordLength; ++t)
+            {
+                if (testLetters[t] == testLetters[i])
+                {
+                    letterCounts[t] = _mm256_add_epi32(letterCounts[t], partial);
+                }
+            }
+        }
+
+        // Every lane is <= 242, so saturating packs narrow 32 bits to 8 bits losslessly
+        const __m256i packed16 = _mm256_packus_epi32(patterns, patterns);
+        const __m256i packed8 = _mm256_packus_epi16(packed16, packed16);
+        const uint32_t lowFour = static_cast<uint32_t>(_mm256_cvtsi256_si32(packed8));
+        const uint32_t highFour = static_cast<uint32_t>(_mm_cvtsi128_si32(_mm256_extracti128_si256(packed8, 1)));
+        memcpy(outPatterns + answer, &lowFour, sizeof(lowFour));
+        memcpy(outPatterns + answer + 4, &highFour, sizeof(highFour));
+    }
+#endif
+
+    for (; answer < numAnswers; ++answer)
+    {
+        outPatterns[answer] = NumberWord(answerValues[answer], 0).ComputeTestResults(testWord);
+    }
+}
+
+namespace
+{
+const uint32_t kMatchPatternFileMagic = 0x504D4C57; // "WLMP"
+const uint32_t kMatchPatternFileVersion = 5;
+
+struct MatchPatternFileHeader
+{
+    uint32_t mMagic;
+    uint32_t mVersion;
+    uint32_t mNumWords;
+    uint32_t mNumColumns;
+    uint32_t mBytesPerPattern;
+    uint32_t mPadding;
+    uint64_t mWordListHash;
+};
+
+std::vector<MatchPattern> sMatchPatternStorage;
+std::vector<MatchPattern> sAnswerMajorMatchPatternStorage;
+std::once_flag sAnswerMajorMatchPatternsBuilt;
+ReadOnlyMappedFile sMatchPatternFile;
+
+const char* GetMatchPatternFileName()
+{
+    return (NumberWord::sMatchPatternMatrixMode == MatchPatternMatrixMode::kAnswersOnly) ? "MatchPatternsAnswers.bin" : "MatchPatterns.bin";
+}
+
+size_t GetMatrixSize()
+{
+    return kNumWords * NumberWord::sNumMatchPatternColumns;
+}
+
+size_t GetMatchPatternFileSize()
 {
-    SwapToAllWords();
+    return sizeof(MatchPatternFileHeader) + (GetMatrixSize() * sizeof(MatchPattern));
+}
 
+void AssignMatchPatternColumns()
+{
+    std::fill(std::begin(NumberWord::sMatchPatternColumns), std::end(NumberWord::sMatchPatternColumns), kNoMatchPatternColumn);
+    NumberWord::sNumMatchPatternColumns = 0;
+    if (NumberWord::sMatchPatternMatrixMode == MatchPatternMatrixMode::kAnswersOnly)
+    {
+        // The columns are the answers of Words.h, whichever answers a Dictionary is built with
+        for (size_t i = 0; i < kNumOfAnswerWords; ++i)
+        {
+            NumberWord::sMatchPatternColumns[NumberWord::LookupNumberWord(kAnswerWords[i]).mIndex] = static_cast<uint16_t>(NumberWord::sNumMatchPatternColumns++);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < kNumWords; ++i)
+        {
+            NumberWord::sMatchPatternColumns[i] = static_cast<uint16_t>(NumberWord::sNumMatchPatternColumns++);
+        }
+    }
+}
+
+uint64_t HashWordList()
+{
+    // FNV-1a, so a changed dictionary invalidates any previously written file
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < kNumWords; ++i)
+    {
+        for (size_t c = 0; c < kWordLength; ++c)
+        {
+            hash ^= static_cast<uint8_t>(kWordList[i][c]);
+            hash *= 1099511628211ull;
+        }
+    }
+    // The answers-only columns come from the answer list, so that takes part too
     for (size_t i = 0; i < kNumOfAnswerWords; ++i)
     {
-        sAnswerWords.push_back(NumberWord::LookupNumberWord(kAnswerWords[i]));
+        for (size_t c = 0; c < kWordLength; ++c)
+        {
+            hash ^= static_cast<uint8_t>(kAnswerWords[i][c]);
+            hash *= 1099511628211ull;
+        }
     }
+    return hash;
+}
 
-    for (size_t i = 0; i < kNumDifficultToEvalWords; ++i)
+MatchPatternFileHeader MakeMatchPatternFileHeader()
+{
+    MatchPatternFileHeader header;
+    header.mMagic = kMatchPatternFileMagic;
+    header.mVersion = kMatchPatternFileVersion;
+    header.mNumWords = static_cast<uint32_t>(kNumWords);
+    header.mNumColumns = static_cast<uint32_t>(NumberWord::sNumMatchPatternColumns);
+    header.mBytesPerPattern = sizeof(MatchPattern);
+    header.mPadding = 0;
+    header.mWordListHash = HashWordList();
+    return header;
+}
+
+bool MapMatchPatternFile()
+{
+    if (!sMatchPatternFile.Open(GetMatchPatternFileName()))
     {
-        sDifficultToEvalWords.push_back(NumberWord::LookupNumberWord(kDifficultToEvalWords[i]));
+        return false;
     }
 
-    for (size_t i = 0; i < kNumVERYDifficultToEvalWords; ++i)
+    const MatchPatternFileHeader expectedHeader = MakeMatchPatternFileHeader();
+    if (sMatchPatternFile.GetSize() != GetMatchPatternFileSize()
+        || memcmp(sMatchPatternFile.GetData(), &expectedHeader, sizeof(MatchPatternFileHeader)) != 0)
     {
-        sVERYDifficultToEvalWords.push_back(NumberWord::LookupNumberWord(kVERYDifficultToEvalWords[i]));
+        printf("Ignoring stale %s\n", GetMatchPatternFileName());
+        sMatchPatternFile.Close();
+        return false;
     }
 
-    for (size_t i = 0; i < kNumFirst2049MatchedWords; ++i)
+    return true;
+}
+
+void ComputeMatchPatterns(MatchPattern* const outTestMajorPatterns)
+{
+    const size_t numColumns = NumberWord::sNumMatchPatternColumns;
+    std::vector<NumberWord> allWords;
+    std::vector<uint32_t> columnWordValues(numColumns);
+    allWords.reserve(kNumWords);
+    for (size_t i = 0; i < kNumWords; ++i)
     {
-        s2049MatchedWords.push_back(NumberWord::LookupNumberWord(kFirst2049MatchedWords[i]));
+        allWords.emplace_back(kWordList[i], static_cast<uint16_t>(i));
+        if (NumberWord::sMatchPatternColumns[i] != kNoMatchPatternColumn)
+        {
+            columnWordValues[NumberWord::sMatchPatternColumns[i]] = allWords.back().mValue;
+        }
     }
+
+    // Rows are handed out one test word at a time, so uneven thread speeds still balance out.
+    // A row is every column word scored against one test word, which is exactly one batch.
+    std::atomic<size_t> nextRow(0);
+    ThreadPool::Get().RunOnAllWorkers([&](size_t)
+    {
+        for (size_t row = nextRow++; row < kNumWords; row = nextRow++)
+        {
+            NumberWord::ComputeTestResultsBatch(allWords[row], columnWordValues.data(), numColumns, outTestMajorPatterns + (row * numColumns));
+        }
+    });
 }
 
-void NumberWord::SwapToAllWords()
+void TransposeMatchPatterns(const MatchPattern* const testMajorPatterns, MatchPattern* const outAnswerMajorPatterns)
 {
-    sAllWords.clear();
+    // In tiles small enough that both sides stay in cache. On threads of its own rather than the pool's, since the
+    // first lookup that wants it may be anywhere, pool work included.
+    const size_t numColumns = NumberWord::sNumMatchPatternColumns;
+    const size_t kTileSize = 64;
+    const size_t numTiles = (numColumns + kTileSize - 1) / kTileSize;
+    std::atomic<size_t> nextColumnTile(0);
+    const auto transposeTiles = [&]()
+    {
+        for (size_t columnTile = nextColumnTile++; columnTile < numTiles; columnTile = nextColumnTile++)
+        {
+            const size_t firstColumn = columnTile * kTileSize;
+            const size_t lastColumn = std::min(firstColumn + kTileSize, numColumns);
+            for (size_t firstTest = 0; firstTest < kNumWords; firstTest += kTileSize)
+            {
+                const size_t lastTest = std::min(firstTest + kTileSize, kNumWords);
+                for (size_t column = firstColumn; column < lastColumn; ++column)
+                {
+                    for (size_t test = firstTest; test < lastTest; ++test)
+                    {
+                        outAnswerMajorPatterns[(column * kNumWords) + test] = testMajorPatterns[(test * numColumns) + column];
+                    }
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::max<size_t>(1u, std::thread::hardware_concurrency()); ++i)
+    {
+        threads.emplace_back(transposeTiles);
+    }
+    transposeTiles();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+bool WriteMatchPatternFile(const MatchPattern* const matchPatterns)
+{
+    const std::string tempFileName = std::string(GetMatchPatternFileName()) + ".tmp";
+    {
+        std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        const MatchPatternFileHeader header = MakeMatchPatternFileHeader();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(matchPatterns), GetMatrixSize() * sizeof(MatchPattern));
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    remove(GetMatchPatternFileName());
+    return rename(tempFileName.c_str(), GetMatchPatternFileName()) == 0;
+}
+} // namespace
+
+void NumberWord::Initialize(const MatchPatternMatrixMode matrixMode)
+{
+    sWordListValues.reserve(kNumWords);
     for (size_t i = 0; i < kNumWords; ++i)
     {
-        sAllWords.emplace_back(kWordList[i], static_cast<uint16_t>(i));
+        sWordListValues.push_back(NumberWord(kWordList[i], static_cast<uint16_t>(i)).mValue);
+    }
+
+    sMatchPatternMatrixMode = matrixMode;
+    AssignMatchPatternColumns();
+
+    if (MapMatchPatternFile())
+    {
+        sTestMajorMatchPatterns = reinterpret_cast<const MatchPattern*>(sMatchPatternFile.GetData() + sizeof(MatchPatternFileHeader));
+        printf("Mapped match patterns from %s\n", GetMatchPatternFileName());
+    }
+    else
+    {
+        RebuildMatchPatterns();
+    }
+}
+
+void NumberWord::RebuildMatchPatterns()
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    const size_t matrixSize = GetMatrixSize();
+
+    // An answer-major table already transposed stays, the same words give the same patterns
+    sTestMajorMatchPatterns = nullptr;
+    sMatchPatternFile.Close();
+    sMatchPatternStorage.resize(matrixSize);
+    ComputeMatchPatterns(sMatchPatternStorage.data());
+    sTestMajorMatchPatterns = sMatchPatternStorage.data();
+
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    printf("Computed %zu match patterns in %.2fs", matrixSize, elapsed.count());
+
+    if (WriteMatchPatternFile(sMatchPatternStorage.data()))
+    {
+        printf(", saved to %s\n", GetMatchPatternFileName());
+    }
+    else
+    {
+        printf(", but could not save to %s\n", GetMatchPatternFileName());
+    }
+}
+
+const MatchPattern* NumberWord::GetAnswerMajorMatchPatterns()
+{
+    std::call_once(sAnswerMajorMatchPatternsBuilt, []()
+    {
+        sAnswerMajorMatchPatternStorage.resize(GetMatrixSize());
+        TransposeMatchPatterns(sTestMajorMatchPatterns, sAnswerMajorMatchPatternStorage.data());
+    });
+    return sAnswerMajorMatchPatternStorage.data();
+}
+
+void NumberWord::GetTestResultsForWholeDictionary(const NumberWord& testWord, MatchPattern* const outPatterns)
+{
+    if (sMatchPatternMatrixMode == MatchPatternMatrixMode::kAllWords)
+    {
+        memcpy(outPatterns, sTestMajorMatchPatterns + (static_cast<size_t>(testWord.mIndex) * kNumWords), kNumWords * sizeof(MatchPattern));
+    }
+    else
+    {
+        ComputeTestResultsBatch(testWord, sWordListValues.data(), kNumWords, outPatterns);
+    }
+}
+
+MatchPatternLookup::MatchPatternLookup(const std::vector<NumberWord>& possibilities)
+{
+    Assign(possibilities);
+}
+
+MatchPatternLookup::MatchPatternLookup(const std::vector<NumberWord>& possibilities, const MatchPatternLayout preferredLayout)
+{
+    Assign(possibilities, preferredLayout);
+}
+
+void MatchPatternLookup::Assign(const std::vector<NumberWord>& possibilities)
+{
+    Assign(possibilities, (possibilities.size() >= kMinPossibilitiesForTestMajorLookup) ? MatchPatternLayout::kTestMajor : MatchPatternLayout::kAnswerMajor);
+}
+
+void MatchPatternLookup::Assign(const std::vector<NumberWord>& possibilities, const MatchPatternLayout preferredLayout)
+{
+    AssignWordIndices(possibilities.size(), preferredLayout, [&possibilities](const size_t i) { return possibilities[i].mIndex; });
+}
+
+void MatchPatternLookup::Assign(const uint16_t* const wordIndices, const size_t numWords)
+{
+    AssignWordIndices(numWords, (numWords >= kMinPossibilitiesForTestMajorLookup) ? MatchPatternLayout::kTestMajor : MatchPatternLayout::kAnswerMajor,
+        [wordIndices](const size_t i) { return wordIndices[i]; });
+}
+
+template <typename WordIndexAt>
+void MatchPatternLookup::AssignWordIndices(const size_t numWords, const MatchPatternLayout preferredLayout, WordIndexAt wordIndexAt)
+{
+    mOffsets.clear();
+    mOffsets.reserve(numWords);
+
+    mLayout = preferredLayout;
+    mPatterns = nullptr;
+    mTestStride = 0;
+    for (size_t i = 0; i < numWords; ++i)
+    {
+        if (NumberWord::sMatchPatternColumns[wordIndexAt(i)] == kNoMatchPatternColumn)
+        {
+            mLayout = MatchPatternLayout::kComputed;
+            break;
+        }
+    }
+
+    if (mLayout == MatchPatternLayout::kTestMajor)
+    {
+        mPatterns = NumberWord::sTestMajorMatchPatterns;
+        mTestStride = NumberWord::sNumMatchPatternColumns;
+        for (size_t i = 0; i < numWords; ++i)
+        {
+            mOffsets.push_back(NumberWord::sMatchPatternColumns[wordIndexAt(i)]);
+        }
+    }
+    else if (mLayout == MatchPatternLayout::kAnswerMajor)
+    {
+        mPatterns = NumberWord::GetAnswerMajorMatchPatterns();
+        mTestStride = 1;
+        for (size_t i = 0; i < numWords; ++i)
+        {
+            mOffsets.push_back(static_cast<uint32_t>(NumberWord::sMatchPatternColumns[wordIndexAt(i)]) * static_cast<uint32_t>(kNumWords));
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < numWords; ++i)
+        {
+            mOffsets.push_back(NumberWord::sWordListValues[wordIndexAt(i)]);
+        }
     }
 }
 
-void NumberWord::SwapToSmallSetOfWords()
+void PatternPartition::Assign(const NumberWord& guess, const uint16_t* const wordIndices, const size_t numWords, uint16_t* const outBucketed)
 {
-    sAllWords.clear();
-    for (size_t i = 0; i < kNumWords; i += 32)
+    AssignItems(guess, numWords, outBucketed, [wordIndices](const size_t i) { return NumberWord::GetDictionaryWord(wordIndices[i]); },
+        [wordIndices](const size_t i) { return wordIndices[i]; });
+}
+
+void PatternPartition::Assign(const NumberWord& guess, const std::vector<NumberWord>& words, uint16_t* const outBucketed)
+{
+    AssignItems(guess, words.size(), outBucketed, [&words](const size_t i) -> const NumberWord& { return words[i]; },
+        [&words](const size_t i) { return words[i].mIndex; });
+}
+
+void PatternPartition::Assign(const NumberWord& guess, const std::vector<NumberWord>& words, const uint16_t* const positions, const size_t numPositions, uint16_t* const outBucketed)
+{
+    AssignItems(guess, numPositions, outBucketed, [&words, positions](const size_t i) -> const NumberWord& { return words[positions[i]]; },
+        [positions](const size_t i) { return positions[i]; });
+}
+
+template <typename WordAt, typename ItemAt>
+void PatternPartition::AssignItems(const NumberWord& guess, const size_t numItems, uint16_t* const outBucketed, WordAt wordAt, ItemAt itemAt)
+{
+    mGuess = guess;
+    mBucketed = outBucketed;
+
+    // Counted one ahead, so the running sum leaves each pattern's start in its own slot
+    memset(mBucketStarts, 0, sizeof(mBucketStarts));
+    for (size_t i = 0; i < numItems; ++i)
+    {
+        ++mBucketStarts[wordAt(i).GetTestResults(guess) + 1];
+    }
+    for (size_t pattern = 0; pattern < kMatchPatternHistogramSize; ++pattern)
+    {
+        mBucketStarts[pattern + 1] += mBucketStarts[pattern];
+    }
+
+    // Patterns are looked up again rather than kept, so no scratch buffer is needed
+    uint32_t bucketEnds[kMatchPatternHistogramSize];
+    memcpy(bucketEnds, mBucketStarts, sizeof(bucketEnds));
+    for (size_t i = 0; i < numItems; ++i)
     {
-        sAllWords.emplace_back(kWordList[i], static_cast<uint16_t>(i));
+        outBucketed[bucketEnds[wordAt(i).GetTestResults(guess)]++] = itemAt(i);
     }
 }
 
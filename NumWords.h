@@ -11,17 +11,6 @@ enum class SingleMatch : uint16_t
 };
 
 const uint32_t kBitsPerLetter = 5;
-const uint16_t kBitsPerMatch = 2;
-
-constexpr uint16_t GenerateMatchMask(const SingleMatch type)
-{
-    uint16_t mask = 0;
-    for (size_t i = 0; i < kWordLength; ++i)
-    {
-        mask += static_cast<uint16_t>(type) << (i * kBitsPerMatch);
-    }
-    return mask;
-}
 
 const uint32_t kLetterMatchBitmask[kWordLength] = {
     0b0000000000000000000011111,
@@ -31,12 +20,71 @@ const uint32_t kLetterMatchBitmask[kWordLength] = {
     0b1111100000000000000000000
 };
 
+// A match pattern is one base-3 digit (a SingleMatch) per letter, letter 0 being the least significant digit.
+// Every legal pattern is dense in 0..242, so histograms over patterns only need kNumMatchPatterns bins.
+using MatchPattern = uint8_t;
+
+constexpr uint8_t kMatchPatternDigitValue[kWordLength] = { 1, 3, 9, 27, 81 };
+const size_t kNumMatchPatterns = 243;
+const MatchPattern kPerfectMatch = static_cast<MatchPattern>(kNumMatchPatterns - 1);
+
+// Histograms over match patterns round their bin count up to 256, so zeroing and scanning them vectorizes cleanly
+const size_t kMatchPatternHistogramSize = 256;
+
+inline void SplitMatchPattern(MatchPattern pattern, SingleMatch outSingleMatches[kWordLength])
+{
+    for (size_t i = 0; i < kWordLength; ++i)
+    {
+        outSingleMatches[i] = static_cast<SingleMatch>(pattern % 3);
+        pattern /= 3;
+    }
+}
+
+// The old pattern format: 2 bits per letter, plus an earmark bit so no valid pattern was 0.
+// Still used for printing and for patterns typed in by hand (e.g. the infamous 2049).
+const uint16_t kBitsPerMatch = 2;
 const uint16_t kEarmarkMatchPattern = 0b100000000000;
 
-const uint16_t kMatchPartialMask = GenerateMatchMask(SingleMatch::kPartial);
-const uint16_t kMatchHitMask = GenerateMatchMask(SingleMatch::kHit);
+constexpr MatchPattern ConvertFromLegacyMatchPattern(const uint16_t legacyPattern)
+{
+    uint32_t pattern = 0;
+    for (size_t i = 0; i < kWordLength; ++i)
+    {
+        const uint32_t singleMatch = (legacyPattern >> (i * kBitsPerMatch)) & static_cast<uint16_t>(SingleMatch::kAnyMask);
+        pattern += singleMatch * kMatchPatternDigitValue[i];
+    }
+    return static_cast<MatchPattern>(pattern);
+}
 
-const uint16_t kPerfectMatch = kEarmarkMatchPattern + kMatchHitMask;
+constexpr uint16_t ConvertToLegacyMatchPattern(const MatchPattern pattern)
+{
+    uint16_t legacyPattern = kEarmarkMatchPattern;
+    uint32_t remainingPattern = pattern;
+    for (size_t i = 0; i < kWordLength; ++i)
+    {
+        legacyPattern += static_cast<uint16_t>((remainingPattern % 3) << (i * kBitsPerMatch));
+        remainingPattern /= 3;
+    }
+    return legacyPattern;
+}
+
+enum class MatchPatternMatrixMode : uint8_t
+{
+    kAllWords,      // Every dictionary word is a column of the matrix (kNumWords x kNumWords)
+    kAnswersOnly    // Only the answer words are columns (kNumWords x kNumOfAnswerWords), ~60 MB instead of ~336 MB
+};
+
+enum class MatchPatternLayout : uint8_t
+{
+    kComputed,      // Not every possibility is a matrix column, so patterns are computed with the batch kernel
+    kAnswerMajor,
+    kTestMajor
+};
+
+const uint16_t kNoMatchPatternColumn = UINT16_MAX;
+
+// Measured crossover on the full dictionary, see Benchmark::COMMAND_MatchPatternLayouts
+const size_t kMinPossibilitiesForTestMajorLookup = 1536;
 
 class NumberWord
 {
@@ -66,22 +114,27 @@ public:
     bool operator!=(const NumberWord& other) const { return mValue != other.mValue; }
 
 
-    uint16_t GetTestResults(const NumberWord& testWord) const
+    MatchPattern GetTestResults(const NumberWord& testWord) const
     {
-        if (sMatchSetToMatchPattern[mIndex][testWord.mIndex] != 0)
+        const uint16_t column = sMatchPatternColumns[mIndex];
+        if (column == kNoMatchPatternColumn)
         {
-            return sMatchSetToMatchPattern[mIndex][testWord.mIndex];
+            return ComputeTestResults(testWord);
         }
+        return sTestMajorMatchPatterns[(static_cast<size_t>(testWord.mIndex) * sNumMatchPatternColumns) + column];
+    }
 
+    MatchPattern ComputeTestResults(const NumberWord& testWord) const
+    {
         uint32_t remainingValue = mValue;
         uint32_t remainingTest = testWord.mValue;
 
-        uint16_t testResult = 0;
+        uint32_t testResult = 0;
         for (size_t i = 0; i < kWordLength; ++i)
         {
             if ((remainingTest & kLetterMatchBitmask[i]) == (remainingValue & kLetterMatchBitmask[i]))
             {
-                testResult += static_cast<uint16_t>(SingleMatch::kHit) << (i * kBitsPerMatch);
+                testResult += static_cast<uint32_t>(SingleMatch::kHit) * kMatchPatternDigitValue[i];
                 remainingValue &= ~kLetterMatchBitmask[i];
                 remainingTest &= ~kLetterMatchBitmask[i];
             }
@@ -97,7 +150,7 @@ public:
                     const uint32_t remainingValueLetter = (remainingValue & kLetterMatchBitmask[t]) >> (t * kBitsPerLetter);
                     if (remainingTestLetter == remainingValueLetter)
                     {
-                        testResult += static_cast<uint16_t>(SingleMatch::kPartial) << (i * kBitsPerMatch);
+                        testResult += static_cast<uint32_t>(SingleMatch::kPartial) * kMatchPatternDigitValue[i];
                         remainingValue &= ~kLetterMatchBitmask[t];
                         break;
                     }
@@ -105,25 +158,33 @@ public:
             }
         }
 
-        testResult += kEarmarkMatchPattern; // Earmark, so that the check above will not think it's 0
-        sMatchSetToMatchPattern[mIndex][testWord.mIndex] = testResult;
-        return testResult;
+        return static_cast<MatchPattern>(testResult);
     }
 
-    bool IsValidWith(const NumberWord& entryWord, uint16_t matchResults) const
+    // Same result as answer.ComputeTestResults(testWord), for every packed answer value in answerValues.
+    // Uses AVX2 eight answers at a time when the build targets it, scalar otherwise.
+    static void ComputeTestResultsBatch(const NumberWord& testWord, const uint32_t* const answerValues, const size_t numAnswers, MatchPattern* const outPatterns);
+
+    // outPatterns[i] = pattern of dictionary word kWordList[i] against testWord, for all kNumWords words
+    static void GetTestResultsForWholeDictionary(const NumberWord& testWord, MatchPattern* const outPatterns);
+
+    bool IsValidWith(const NumberWord& entryWord, MatchPattern matchResults) const
     {
-        uint16_t competingTestResults = GetTestResults(entryWord);
+        const MatchPattern competingTestResults = GetTestResults(entryWord);
         if (competingTestResults != matchResults)
         {
             return false;
         }
 
+        SingleMatch singleMatches[kWordLength];
+        SplitMatchPattern(matchResults, singleMatches);
+
         uint32_t remainingValue = mValue;
         uint32_t remainingEntry = entryWord.mValue;
 
         for (size_t i = 0; i < kWordLength; ++i)
         {
-            const SingleMatch singleMatch = static_cast<SingleMatch>( (matchResults >> (i * kBitsPerMatch)) & static_cast<uint16_t>(SingleMatch::kAnyMask) );
+            const SingleMatch singleMatch = singleMatches[i];
             if (singleMatch == SingleMatch::kHit)
             {
                 remainingValue &= ~kLetterMatchBitmask[i];
@@ -132,7 +193,7 @@ public:
 
         for (size_t i = 0; i < kWordLength; ++i)
         {
-            const SingleMatch singleMatch = static_cast<SingleMatch>((matchResults >> (i * kBitsPerMatch))& static_cast<uint16_t>(SingleMatch::kAnyMask));
+            const SingleMatch singleMatch = singleMatches[i];
             if (singleMatch == SingleMatch::kPartial)
             {
                 uint32_t entryLetter = (remainingEntry & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
@@ -156,7 +217,7 @@ public:
 
         for (size_t i = 0; i < kWordLength; ++i)
         {
-            const SingleMatch singleMatch = static_cast<SingleMatch>((matchResults >> (i * kBitsPerMatch))& static_cast<uint16_t>(SingleMatch::kAnyMask));
+            const SingleMatch singleMatch = singleMatches[i];
             if (singleMatch == SingleMatch::kMiss)
             {
                 const uint32_t entryLetter = (remainingEntry & kLetterMatchBitmask[i]) >> (i * kBitsPerLetter);
@@ -209,16 +270,164 @@ public:
     uint32_t mValue;
     uint16_t mIndex;
 
-    static uint16_t sMatchSetToMatchPattern[kNumWords][kNumWords];
-    static std::vector<NumberWord> sAllWords;
-    static std::vector<NumberWord> sAnswerWords;
-    static std::vector<NumberWord> sDifficultToEvalWords;
-    static std::vector<NumberWord> sVERYDifficultToEvalWords;
-    static std::vector<NumberWord> s2049MatchedWords;
-    static void Initialize();
-    static void SwapToAllWords();
-    static void SwapToSmallSetOfWords();
+    // Answer word A is matrix column C = sMatchPatternColumns[A.mIndex], or kNoMatchPatternColumn if the matrix mode leaves
+    // it out. Its pattern against test word T lives at [T * sNumMatchPatternColumns + C] in the test-major table, and at
+    // [C * kNumWords + T] in the answer-major table. The test-major table is fully populated by Initialize(), either
+    // mapped read-only from the precomputed match pattern file, or computed across all cores and then written out. The
+    // file holds only that one, the answer-major table is transposed from it in memory by the first lookup that wants
+    // it, and from then on takes as much memory again.
+    static const MatchPattern* sTestMajorMatchPatterns;
+    static const MatchPattern* GetAnswerMajorMatchPatterns();
+    static uint16_t sMatchPatternColumns[kNumWords];
+    static size_t sNumMatchPatternColumns;
+    static MatchPatternMatrixMode sMatchPatternMatrixMode;
+    static std::vector<uint32_t> sWordListValues; // Packed value of every kWordList word, by index
+    static void Initialize(MatchPatternMatrixMode matrixMode = MatchPatternMatrixMode::kAllWords);
+    static void RebuildMatchPatterns();
     static NumberWord LookupNumberWord(const char* const text);
+    static NumberWord GetDictionaryWord(uint16_t index) { return NumberWord(sWordListValues[index], index); }
+};
+
+// Patterns of any test word against a fixed list of possibilities, from whichever source suits that list. Scoring one test
+// word over many possibilities streams a contiguous test-major row. Over only a few possibilities, walking the test words
+// in order streams each possibility's answer-major row instead, and that wins. If some possibility isn't a matrix column
+// (a non-answer while in kAnswersOnly mode), every pattern is computed on the fly instead.
+class MatchPatternLookup
+{
+public:
+    MatchPatternLookup() = default;
+    explicit MatchPatternLookup(const std::vector<NumberWord>& possibilities);
+    MatchPatternLookup(const std::vector<NumberWord>& possibilities, MatchPatternLayout preferredLayout);
+
+    // Rebuild for other possibilities, reusing the storage of the ones before. Indices are into kWordList.
+    void Assign(const std::vector<NumberWord>& possibilities);
+    void Assign(const std::vector<NumberWord>& possibilities, MatchPatternLayout preferredLayout);
+    void Assign(const uint16_t* const wordIndices, size_t numWords);
+
+    // outPatterns[i] = possibilities[i].GetTestResults(testWord)
+    void GetTestResults(const NumberWord& testWord, MatchPattern* const outPatterns) const
+    {
+        const size_t numPossibilities = mOffsets.size();
+        if (mLayout == MatchPatternLayout::kComputed)
+        {
+            NumberWord::ComputeTestResultsBatch(testWord, mOffsets.data(), numPossibilities, outPatterns);
+            return;
+        }
+
+        const MatchPattern* const testRow = mPatterns + (static_cast<size_t>(testWord.mIndex) * mTestStride);
+        for (size_t i = 0; i < numPossibilities; ++i)
+        {
+            outPatterns[i] = testRow[mOffsets[i]];
+        }
+    }
+
+    // histogram[pattern] += number of possibilities giving that pattern against testWord
+    void AddTestResultsToHistogram(const NumberWord& testWord, uint16_t* const histogram) const
+    {
+        const size_t numPossibilities = mOffsets.size();
+        if (mLayout == MatchPatternLayout::kComputed)
+        {
+            MatchPattern patterns[kMatchPatternHistogramSize];
+            for (size_t first = 0; first < numPossibilities; first += kMatchPatternHistogramSize)
+            {
+                const size_t count = std::min(kMatchPatternHistogramSize, numPossibilities - first);
+                NumberWord::ComputeTestResultsBatch(testWord, mOffsets.data() + first, count, patterns);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    histogram[patterns[i]] += 1;
+                }
+            }
+            return;
+        }
+
+        const MatchPattern* const testRow = mPatterns + (static_cast<size_t>(testWord.mIndex) * mTestStride);
+        for (size_t i = 0; i < numPossibilities; ++i)
+        {
+            histogram[testRow[mOffsets[i]]] += 1;
+        }
+    }
+
+    // Size of the largest group of possibilities sharing one pattern against testWord. Counting stops as soon as any
+    // group reaches abortAtSize, so a result >= abortAtSize only means "at least that", smaller results are exact.
+    uint16_t GetLargestBucketSize(const NumberWord& testWord, const uint16_t abortAtSize) const
+    {
+        const size_t kAbortCheckInterval = 64;
+        const size_t numPossibilities = mOffsets.size();
+        uint16_t histogram[kMatchPatternHistogramSize] = { 0 };
+        uint16_t largestBucketSize = 0;
+
+        if (mLayout == MatchPatternLayout::kComputed)
+        {
+            MatchPattern patterns[kAbortCheckInterval];
+            for (size_t first = 0; first < numPossibilities; first += kAbortCheckInterval)
+            {
+                const size_t count = std::min(kAbortCheckInterval, numPossibilities - first);
+                NumberWord::ComputeTestResultsBatch(testWord, mOffsets.data() + first, count, patterns);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    largestBucketSize = std::max(largestBucketSize, ++histogram[patterns[i]]);
+                }
+                if (largestBucketSize >= abortAtSize)
+                {
+                    break;
+                }
+            }
+            return largestBucketSize;
+        }
+
+        const MatchPattern* const testRow = mPatterns + (static_cast<size_t>(testWord.mIndex) * mTestStride);
+        for (size_t first = 0; first < numPossibilities; first += kAbortCheckInterval)
+        {
+            const size_t last = std::min(first + kAbortCheckInterval, numPossibilities);
+            for (size_t i = first; i < last; ++i)
+            {
+                largestBucketSize = std::max(largestBucketSize, ++histogram[testRow[mOffsets[i]]]);
+            }
+            if (largestBucketSize >= abortAtSize)
+            {
+                break;
+            }
+        }
+        return largestBucketSize;
+    }
+
+    size_t GetNumPossibilities() const { return mOffsets.size(); }
+    MatchPatternLayout GetLayout() const { return mLayout; }
+
+private:
+    template <typename WordIndexAt>
+    void AssignWordIndices(size_t numWords, MatchPatternLayout preferredLayout, WordIndexAt wordIndexAt);
+
+    MatchPatternLayout mLayout = MatchPatternLayout::kComputed;
+    const MatchPattern* mPatterns = nullptr;
+    size_t mTestStride = 0;
+    std::vector<uint32_t> mOffsets; // Offset of each possibility within a test row, or its packed value when computed
+};
+
+// Words split by the pattern each gives against one guess, with a counting sort: one pass counts every pattern, the
+// next scatters the words so each pattern's words sit contiguous and in their original order. The bucketed words go
+// to a buffer the caller owns, with room for all of them, so nothing is allocated.
+class PatternPartition
+{
+public:
+    // wordIndices are into kWordList, and so are the bucketed words
+    void Assign(const NumberWord& guess, const uint16_t* const wordIndices, size_t numWords, uint16_t* const outBucketed);
+    // Buckets the kWordList indices of all of words
+    void Assign(const NumberWord& guess, const std::vector<NumberWord>& words, uint16_t* const outBucketed);
+    // positions are into words, and so are the bucketed words
+    void Assign(const NumberWord& guess, const std::vector<NumberWord>& words, const uint16_t* const positions, size_t numPositions, uint16_t* const outBucketed);
+
+    const NumberWord& GetGuess() const { return mGuess; }
+    const uint16_t* GetBucket(const MatchPattern pattern) const { return mBucketed + mBucketStarts[pattern]; }
+    size_t GetBucketSize(const MatchPattern pattern) const { return mBucketStarts[pattern + 1] - mBucketStarts[pattern]; }
+
+private:
+    template <typename WordAt, typename ItemAt>
+    void AssignItems(const NumberWord& guess, size_t numItems, uint16_t* const outBucketed, WordAt wordAt, ItemAt itemAt);
+
+    NumberWord mGuess = NumberWord(0u, UINT16_MAX);
+    uint16_t* mBucketed = nullptr;
+    uint32_t mBucketStarts[kMatchPatternHistogramSize + 1] = { 0 };
 };
 
 const NumberWord kInvalidNumberWord(0u, UINT16_MAX);
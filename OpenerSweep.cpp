@@ -0,0 +1,306 @@
+#include "OpenerSweep.h"
+
+namespace
+{
+// First line of a journal: "WordlessOpenerSweep <version> <configuration hash>". Every line after is one opener,
+// "<kWordList index> <word> <total steps> <fails> <n> <n counts of targets by steps> ;", the ';' showing it was
+// written out in full.
+const char* const kJournalMagic = "WordlessOpenerSweep";
+const uint32_t kJournalVersion = 1;
+
+// Small enough that the last shards still spread over every worker, large enough to keep each worker's memo warm
+const size_t kOpenersPerShard = 8;
+
+// Reads the next whitespace separated number at text and moves past it, false if there is none
+bool ReadNumber(const char*& text, const int base, uint64_t& outValue)
+{
+    char* end = nullptr;
+    outValue = strtoull(text, &end, base);
+    if (end == text)
+    {
+        return false;
+    }
+    text = end;
+    return true;
+}
+} // namespace
+
+NumWordB::OpenerSweep::OpenerSweep(const char* const journalPath, const Dictionary& dictionary)
+    : mDictionary(dictionary)
+    , mJournalPath(journalPath)
+{
+    NumberWordStrategy strategy(mDictionary);
+    ConfigureStrategy(strategy);
+    mConfigurationHash = strategy.GetConfigurationHash(mDictionary.GetAnswerWords());
+}
+
+NumWordB::OpenerSweep::OpenerSweep(const char* const journalPath, const uint64_t configurationHash, const Dictionary& dictionary)
+    : mDictionary(dictionary)
+    , mJournalPath(journalPath)
+    , mConfigurationHash(configurationHash)
+{
+}
+
+void NumWordB::OpenerSweep::ConfigureStrategy(NumberWordStrategy& strategy)
+{
+    // The same strategy COMMAND_FindFewestStepsOpeningWord always used, with the opener as its first guess
+    strategy.SetSpecificStepStrategy(1, NumberWordStrategy::StepStrategy::kUseInputWord);
+}
+
+void NumWordB::OpenerSweep::LoadJournal()
+{
+    mResults.clear();
+    mIsJournalStarted = false;
+    mIsLastLineCutShort = false;
+
+    std::ifstream journal(mJournalPath);
+    std::string line;
+    if (!journal || !std::getline(journal, line))
+    {
+        return;
+    }
+
+    const char* text = line.c_str();
+    const size_t magicLength = strlen(kJournalMagic);
+    uint64_t version = 0;
+    uint64_t configurationHash = 0;
+    bool isHeaderValid = (strncmp(text, kJournalMagic, magicLength) == 0);
+    if (isHeaderValid)
+    {
+        text += magicLength;
+        isHeaderValid = ReadNumber(text, 10, version) && ReadNumber(text, 16, configurationHash)
+            && (version == kJournalVersion) && (configurationHash == mConfigurationHash);
+    }
+    if (!isHeaderValid)
+    {
+        journal.close();
+        const std::string oldJournalPath = mJournalPath + ".old";
+        remove(oldJournalPath.c_str());
+        rename(mJournalPath.c_str(), oldJournalPath.c_str());
+        printf("%s was written under another configuration, moved it to %s\n", mJournalPath.c_str(), oldJournalPath.c_str());
+        return;
+    }
+
+    mIsJournalStarted = true;
+    while (std::getline(journal, line))
+    {
+        OpenerResult result;
+        if (ParseJournalLine(line, result))
+        {
+            mResults[result.mOpenerIndex] = result;
+        }
+    }
+
+    // New lines must not be appended onto the end of one cut short
+    journal.clear();
+    journal.seekg(-1, std::ios::end);
+    mIsLastLineCutShort = (journal.get() != '\n');
+}
+
+bool NumWordB::OpenerSweep::ParseJournalLine(const std::string& line, OpenerResult& outResult)
+{
+    const size_t kMaxStepCounts = 64;
+    const char* text = line.c_str();
+    uint64_t openerIndex = 0;
+    if (!ReadNumber(text, 10, openerIndex) || (openerIndex >= kNumWords) || (*text++ != ' ') || (strncmp(text, kWordList[openerIndex], kWordLength) != 0))
+    {
+        return false;
+    }
+    text += kWordLength;
+
+    uint64_t totalSteps = 0;
+    uint64_t fails = 0;
+    uint64_t numStepCounts = 0;
+    if (!ReadNumber(text, 10, totalSteps) || !ReadNumber(text, 10, fails) || !ReadNumber(text, 10, numStepCounts) || (numStepCounts > kMaxStepCounts))
+    {
+        return false;
+    }
+
+    outResult.mOpenerIndex = static_cast<uint16_t>(openerIndex);
+    outResult.mTotalSteps = static_cast<uint32_t>(totalSteps);
+    outResult.mFails = static_cast<uint32_t>(fails);
+    outResult.mTargetsBySteps.assign(static_cast<size_t>(numStepCounts), 0);
+    for (uint32_t& count : outResult.mTargetsBySteps)
+    {
+        uint64_t value = 0;
+        if (!ReadNumber(text, 10, value))
+        {
+            return false;
+        }
+        count = static_cast<uint32_t>(value);
+    }
+
+    while (*text == ' ')
+    {
+        ++text;
+    }
+    return *text == ';';
+}
+
+bool NumWordB::OpenerSweep::OpenJournal()
+{
+    if (mIsJournalStarted)
+    {
+        mJournal.open(mJournalPath, std::ios::app);
+        if (mIsLastLineCutShort)
+        {
+            mJournal << '\n';
+            mIsLastLineCutShort = false;
+        }
+    }
+    else
+    {
+        mJournal.open(mJournalPath, std::ios::trunc);
+        mJournal << kJournalMagic << ' ' << kJournalVersion << ' ' << std::hex << mConfigurationHash << std::dec << '\n';
+        mJournal.flush();
+        mIsJournalStarted = true;
+    }
+    return static_cast<bool>(mJournal);
+}
+
+void NumWordB::OpenerSweep::AppendToJournal(const OpenerResult& result)
+{
+    // Called with mJournalMutex held. Flushed per line, whatever made it to disk survives a crash.
+    mJournal << result.mOpenerIndex << ' ' << kWordList[result.mOpenerIndex] << ' ' << result.mTotalSteps << ' ' << result.mFails << ' ' << result.mTargetsBySteps.size();
+    for (const uint32_t count : result.mTargetsBySteps)
+    {
+        mJournal << ' ' << count;
+    }
+    mJournal << " ;\n";
+    mJournal.flush();
+}
+
+void NumWordB::OpenerSweep::Run(const size_t startingIndex, const size_t untilIndex, ThreadPool& threadPool)
+{
+    std::vector<NumberWord> openers;
+    size_t numAlreadyJournaled = 0;
+    for (size_t i = startingIndex; (i <= untilIndex) && (i < mDictionary.GetAllWords().size()); ++i)
+    {
+        const NumberWord& opener = mDictionary.GetAllWords().at(i);
+        if (mResults.find(opener.mIndex) != mResults.end())
+        {
+            ++numAlreadyJournaled;
+            continue;
+        }
+        openers.push_back(opener);
+    }
+
+    printf("%zu openers to score, %zu already in %s\n", openers.size(), numAlreadyJournaled, mJournalPath.c_str());
+    if (openers.empty())
+    {
+        return;
+    }
+
+    if (!OpenJournal())
+    {
+        printf("Could not write to %s, nothing scored will be kept\n", mJournalPath.c_str());
+    }
+
+    // One context is shared by every worker, each opener only changes the input word
+    NumberWordStrategy configuredStrategy(mDictionary);
+    ConfigureStrategy(configuredStrategy);
+    const auto context = std::make_shared<const SolverContext>(configuredStrategy.GetContext()->GetConfiguration(), mDictionary.GetAnswerWords(), mDictionary);
+
+    // Searches inside the workers run on their own thread, the parallelism is across openers instead
+    const size_t numShards = (openers.size() + kOpenersPerShard - 1) / kOpenersPerShard;
+    std::atomic<size_t> nextShard(0);
+    threadPool.RunOnAllWorkers([this, &openers, &nextShard, numShards, &context](size_t)
+    {
+        // Each worker keeps its own strategy, and with it a memo warmed by every opener of its shards
+        NumberWordStrategy strategy(context);
+        std::string textForWord;
+
+        for (size_t shard = nextShard++; shard < numShards; shard = nextShard++)
+        {
+            const size_t lastOpener = std::min((shard + 1) * kOpenersPerShard, openers.size());
+            for (size_t i = shard * kOpenersPerShard; i < lastOpener; ++i)
+            {
+                const NumberWord& opener = openers[i];
+                strategy.SetInputWord(opener);
+
+                OpenerResult result;
+                result.mOpenerIndex = opener.mIndex;
+                result.mFails = strategy.TestAllPossibilities(mDictionary.GetAnswerWords());
+                result.mTargetsBySteps = strategy.GetTargetsBySteps();
+                for (size_t steps = 0; steps < result.mTargetsBySteps.size(); ++steps)
+                {
+                    result.mTotalSteps += static_cast<uint32_t>(steps) * result.mTargetsBySteps[steps];
+                }
+
+                std::lock_guard<std::mutex> lock(mJournalMutex);
+                AppendToJournal(result);
+                mResults[result.mOpenerIndex] = result;
+
+                opener.ConvertToString(textForWord);
+                printf("\n%s : Avg Steps %.4f - %u Ls", textForWord.c_str(), static_cast<double>(result.mTotalSteps) / static_cast<double>(GetNumTargets()), result.mFails);
+            }
+        }
+    });
+
+    mJournal.close();
+    putchar('\n');
+}
+
+void NumWordB::OpenerSweep::Record(const OpenerResult& result)
+{
+    std::lock_guard<std::mutex> lock(mJournalMutex);
+    if (OpenJournal())
+    {
+        AppendToJournal(result);
+    }
+    else
+    {
+        printf("Could not write to %s, the result won't be kept\n", mJournalPath.c_str());
+    }
+    mJournal.close();
+    mResults[result.mOpenerIndex] = result;
+}
+
+std::vector<NumWordB::OpenerResult> NumWordB::OpenerSweep::Merge() const
+{
+    std::vector<OpenerResult> ranking;
+    ranking.reserve(mResults.size());
+    for (const auto& entry : mResults)
+    {
+        ranking.push_back(entry.second);
+    }
+
+    std::sort(ranking.begin(), ranking.end(), [](const OpenerResult& a, const OpenerResult& b)
+    {
+        if (a.mTotalSteps != b.mTotalSteps)
+        {
+            return a.mTotalSteps < b.mTotalSteps;
+        }
+        if (a.mFails != b.mFails)
+        {
+            return a.mFails < b.mFails;
+        }
+        return a.mOpenerIndex < b.mOpenerIndex;
+    });
+    return ranking;
+}
+
+void NumWordB::OpenerSweep::PrintRanking(const size_t maxOpeners) const
+{
+    const std::vector<OpenerResult> ranking = Merge();
+    if (ranking.empty())
+    {
+        printf("\nNo openers journaled in %s yet\n", mJournalPath.c_str());
+        return;
+    }
+
+    printf("\nBest of %zu journaled openers, by steps taken for all %zu answers:", ranking.size(), GetNumTargets());
+    for (size_t rank = 0; (rank < ranking.size()) && (rank < maxOpeners); ++rank)
+    {
+        const OpenerResult& result = ranking[rank];
+        printf("\n %4zu. %s : Avg Steps %.4f - %u Ls -", rank + 1, kWordList[result.mOpenerIndex],
+            static_cast<double>(result.mTotalSteps) / static_cast<double>(GetNumTargets()), result.mFails);
+        for (size_t steps = 1; steps < result.mTargetsBySteps.size(); ++steps)
+        {
+            printf(" %u", result.mTargetsBySteps[steps]);
+        }
+    }
+
+    printf("\n\nLowest average steps at: %.4f\n", static_cast<double>(ranking.front().mTotalSteps) / static_cast<double>(GetNumTargets()));
+    printf(" %s", kWordList[ranking.front().mOpenerIndex]);
+}
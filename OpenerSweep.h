@@ -0,0 +1,70 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "CommandNumWordB.h"
+#include "Dictionary.h"
+#include "ThreadPool.h"
+
+namespace NumWordB
+{
+const char* const kOpenerSweepJournalFileName = "OpenerSweep.journal";
+
+struct OpenerResult
+{
+    uint16_t mOpenerIndex = 0; // Into kWordList
+    uint32_t mTotalSteps = 0;
+    uint32_t mFails = 0;
+    std::vector<uint32_t> mTargetsBySteps; // [steps] = targets solved in that many steps
+};
+
+// Scores opening words against every answer, in shards of openers spread over the thread pool. Each result is
+// appended to a journal as soon as it is known, so a sweep that gets interrupted picks up where it stopped, and the
+// ranking always covers every opener journaled under the same configuration, whichever run scored it. The openers are
+// the dictionary's test words and the targets its answers. Sweeps over different dictionaries run side by side when
+// each is given a pool of its own.
+class OpenerSweep
+{
+public:
+    OpenerSweep(const char* const journalPath, const Dictionary& dictionary);
+    // For results scored some other way, journaled under that scorer's own configuration hash
+    OpenerSweep(const char* const journalPath, uint64_t configurationHash, const Dictionary& dictionary);
+
+    OpenerSweep(const OpenerSweep&) = delete;
+    OpenerSweep& operator=(const OpenerSweep&) = delete;
+
+    // Reads what the journal already holds. A journal from another configuration is set aside to start over, and a
+    // last line cut short by a crash is ignored.
+    void LoadJournal();
+
+    // Scores the openers at test word positions startingIndex through untilIndex that the journal doesn't have yet,
+    // spread over threadPool
+    void Run(size_t startingIndex, size_t untilIndex, ThreadPool& threadPool);
+
+    // Journals one opener scored outside of Run
+    void Record(const OpenerResult& result);
+    bool IsJournaled(const uint16_t openerIndex) const { return mResults.find(openerIndex) != mResults.end(); }
+
+    // Every journaled result, best first: fewest total steps, then fewest fails, then dictionary order
+    std::vector<OpenerResult> Merge() const;
+    void PrintRanking(size_t maxOpeners) const;
+
+    size_t GetNumJournaledOpeners() const { return mResults.size(); }
+    size_t GetNumTargets() const { return mDictionary.GetAnswerWords().size(); }
+
+private:
+    static void ConfigureStrategy(NumberWordStrategy& strategy);
+    static bool ParseJournalLine(const std::string& line, OpenerResult& outResult);
+    bool OpenJournal();
+    void AppendToJournal(const OpenerResult& result);
+
+    const Dictionary& mDictionary;
+    std::string mJournalPath;
+    uint64_t mConfigurationHash = 0;
+    bool mIsJournalStarted = false;
+    bool mIsLastLineCutShort = false;
+
+    std::mutex mJournalMutex;
+    std::ofstream mJournal;
+    std::map<uint16_t, OpenerResult> mResults; // By opener
+};
+} // namespace NumWordB
@@ -0,0 +1,135 @@
+#include "OpeningBook.h"
+
+namespace
+{
+const uint32_t kOpeningBookFileMagic = 0x424F4C57; // "WLOB"
+const uint32_t kOpeningBookFileVersion = 1;
+
+struct OpeningBookFileHeader
+{
+    uint32_t mMagic;
+    uint32_t mVersion;
+    uint64_t mConfigurationHash;
+    uint16_t mOpenerIndex;
+    uint16_t mPadding;
+    uint32_t mNumEntries;
+};
+
+uint16_t MakeHistory(const MatchPattern firstPattern, const uint8_t secondPattern)
+{
+    return static_cast<uint16_t>((static_cast<uint32_t>(firstPattern) << 8) | secondPattern);
+}
+} // namespace
+
+void OpeningBook::Reset(const uint64_t configurationHash, const NumberWord& opener)
+{
+    mFile.Close();
+    mBuiltEntries.clear();
+    mConfigurationHash = configurationHash;
+    mOpenerIndex = opener.mIndex;
+    mEntries = nullptr;
+    mNumEntries = 0;
+}
+
+void OpeningBook::AddGuess(const MatchPattern firstPattern, const uint8_t secondPattern, const NumberWord& guess)
+{
+    OpeningBookEntry entry;
+    entry.mHistory = MakeHistory(firstPattern, secondPattern);
+    entry.mGuessIndex = guess.mIndex;
+    const auto position = std::lower_bound(mBuiltEntries.begin(), mBuiltEntries.end(), entry.mHistory,
+        [](const OpeningBookEntry& e, const uint16_t history) { return e.mHistory < history; });
+    mBuiltEntries.insert(position, entry);
+
+    // Growing the vector moves it, so the read side is pointed at it again every time
+    mEntries = mBuiltEntries.data();
+    mNumEntries = mBuiltEntries.size();
+}
+
+bool OpeningBook::Save(const char* const path) const
+{
+    const std::string tempFileName = std::string(path) + ".tmp";
+    {
+        std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            return false;
+        }
+
+        OpeningBookFileHeader header = {};
+        header.mMagic = kOpeningBookFileMagic;
+        header.mVersion = kOpeningBookFileVersion;
+        header.mConfigurationHash = mConfigurationHash;
+        header.mOpenerIndex = mOpenerIndex;
+        header.mNumEntries = static_cast<uint32_t>(mNumEntries);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(mEntries), mNumEntries * sizeof(OpeningBookEntry));
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    remove(path);
+    return rename(tempFileName.c_str(), path) == 0;
+}
+
+bool OpeningBook::Load(const char* const path)
+{
+    Reset(0, kInvalidNumberWord);
+    if (!mFile.Open(path) || (mFile.GetSize() < sizeof(OpeningBookFileHeader)))
+    {
+        mFile.Close();
+        return false;
+    }
+
+    OpeningBookFileHeader header;
+    memcpy(&header, mFile.GetData(), sizeof(header));
+    const size_t expectedSize = sizeof(OpeningBookFileHeader) + (header.mNumEntries * sizeof(OpeningBookEntry));
+    if ((header.mMagic != kOpeningBookFileMagic) || (header.mVersion != kOpeningBookFileVersion)
+        || (mFile.GetSize() != expectedSize) || (header.mNumEntries == 0) || (header.mOpenerIndex >= kNumWords))
+    {
+        mFile.Close();
+        return false;
+    }
+
+    mConfigurationHash = header.mConfigurationHash;
+    mOpenerIndex = header.mOpenerIndex;
+    mEntries = reinterpret_cast<const OpeningBookEntry*>(mFile.GetData() + sizeof(OpeningBookFileHeader));
+    mNumEntries = header.mNumEntries;
+    return true;
+}
+
+const OpeningBookEntry* OpeningBook::FindEntry(const uint16_t history) const
+{
+    const OpeningBookEntry* const lastEntry = mEntries + mNumEntries;
+    const OpeningBookEntry* const entry = std::lower_bound(mEntries, lastEntry, history,
+        [](const OpeningBookEntry& e, const uint16_t h) { return e.mHistory < h; });
+    return ((entry != lastEntry) && (entry->mHistory == history)) ? entry : nullptr;
+}
+
+NumberWord OpeningBook::FindGuess(const uint32_t* const guessHistory, const size_t numGuesses) const
+{
+    if ((numGuesses == 0) || (numGuesses > 2) || ((guessHistory[0] >> 8) != mOpenerIndex))
+    {
+        return kInvalidNumberWord;
+    }
+
+    const MatchPattern firstPattern = static_cast<MatchPattern>(guessHistory[0] & 0xFF);
+    const OpeningBookEntry* const entry = FindEntry(MakeHistory(firstPattern, kNoPattern));
+    if (entry == nullptr)
+    {
+        return kInvalidNumberWord;
+    }
+    if (numGuesses == 1)
+    {
+        return NumberWord::GetDictionaryWord(entry->mGuessIndex);
+    }
+
+    // The book's second step guesses were only ever worked out after its own first
+    if ((guessHistory[1] >> 8) != entry->mGuessIndex)
+    {
+        return kInvalidNumberWord;
+    }
+    const OpeningBookEntry* const nextEntry = FindEntry(MakeHistory(firstPattern, static_cast<uint8_t>(guessHistory[1] & 0xFF)));
+    return (nextEntry != nullptr) ? NumberWord::GetDictionaryWord(nextEntry->mGuessIndex) : kInvalidNumberWord;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "MappedFile.h"
+
+// On-disk layout, after the header: every entry, sorted by history. The history is (first pattern << 8) | second
+// pattern, the second being OpeningBook::kNoPattern for the guess right after the opener.
+struct OpeningBookEntry
+{
+    uint16_t mHistory;
+    uint16_t mGuessIndex;   // Into kWordList
+};
+
+// The guesses for the two steps after an opener, each worked out ahead of time by a search deeper than a strategy can
+// afford while playing. An entry is keyed by the patterns the opener and the book's own guess after it got, so the
+// book only answers while play has followed it.
+class OpeningBook
+{
+public:
+    static const uint8_t kNoPattern = 0xFF;
+
+    OpeningBook() = default;
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Building. Entries may be added in any order, each history once.
+    void Reset(uint64_t configurationHash, const NumberWord& opener);
+    void AddGuess(MatchPattern firstPattern, uint8_t secondPattern, const NumberWord& guess);
+    bool Save(const char* const path) const;
+
+    // Maps a saved book. Which configuration it is good for is up to the strategy using it.
+    bool Load(const char* const path);
+
+    bool IsEmpty() const { return mNumEntries == 0; }
+    size_t GetNumEntries() const { return mNumEntries; }
+    uint64_t GetConfigurationHash() const { return mConfigurationHash; }
+    NumberWord GetOpener() const { return NumberWord::GetDictionaryWord(mOpenerIndex); }
+    // The guess after guessHistory, (kWordList index << 8) | pattern of every guess from the opener on, or
+    // kInvalidNumberWord once play has left the book
+    NumberWord FindGuess(const uint32_t* guessHistory, size_t numGuesses) const;
+
+private:
+    const OpeningBookEntry* FindEntry(uint16_t history) const;
+
+    uint64_t mConfigurationHash = 0;
+    uint16_t mOpenerIndex = 0;
+    const OpeningBookEntry* mEntries = nullptr;
+    size_t mNumEntries = 0;
+
+    std::vector<OpeningBookEntry> mBuiltEntries;
+    ReadOnlyMappedFile mFile;
+};
@@ -0,0 +1,282 @@
+#include "PossibilitySet.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace
+{
+// Each mask is ~1.6 KB, so this caps the cache around 26 MB. Long sweeps over many openers would otherwise keep every
+// branch they ever took.
+const size_t kMaxCachedMasks = 16384;
+// All the masks of one guess share a shard, so filling in a guess's masks takes a single shard's lock
+const size_t kNumMaskCacheShards = 16;
+const size_t kMaxCachedMasksPerShard = kMaxCachedMasks / kNumMaskCacheShards;
+
+// Masks are built outside the lock and only inserted under it, and a mask handed out stays good after it is evicted.
+// A full shard evicts in clock order: the hand passes over masks used since it last came by, clearing their mark.
+class MaskCacheShard
+{
+public:
+    std::shared_ptr<const PossibilitySet> Find(const uint32_t key)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return FindLocked(key);
+    }
+
+    // Must be called with mMutex held
+    std::shared_ptr<const PossibilitySet> FindLocked(const uint32_t key)
+    {
+        const auto iter = mSlotByKey.find(key);
+        if (iter == mSlotByKey.end())
+        {
+            return nullptr;
+        }
+        Slot& slot = mSlots[iter->second];
+        slot.mIsReferenced = true;
+        return slot.mMask;
+    }
+
+    // Must be called with mMutex held. A mask some other thread inserted first is kept instead.
+    std::shared_ptr<const PossibilitySet> InsertLocked(const uint32_t key, std::shared_ptr<const PossibilitySet> mask)
+    {
+        const auto iter = mSlotByKey.find(key);
+        if (iter != mSlotByKey.end())
+        {
+            return mSlots[iter->second].mMask;
+        }
+
+        size_t slotIndex = mSlots.size();
+        if (slotIndex < kMaxCachedMasksPerShard)
+        {
+            mSlots.emplace_back();
+        }
+        else
+        {
+            while (mSlots[mClockHand].mIsReferenced)
+            {
+                mSlots[mClockHand].mIsReferenced = false;
+                mClockHand = (mClockHand + 1) % mSlots.size();
+            }
+            slotIndex = mClockHand;
+            mClockHand = (mClockHand + 1) % mSlots.size();
+            mSlotByKey.erase(mSlots[slotIndex].mKey);
+        }
+
+        Slot& slot = mSlots[slotIndex];
+        slot.mKey = key;
+        slot.mIsReferenced = true;
+        slot.mMask = std::move(mask);
+        mSlotByKey[key] = slotIndex;
+        return slot.mMask;
+    }
+
+    size_t GetNumMasks()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mSlots.size();
+    }
+
+    std::mutex mMutex;
+
+private:
+    struct Slot
+    {
+        uint32_t mKey = 0;
+        bool mIsReferenced = false;
+        std::shared_ptr<const PossibilitySet> mMask;
+    };
+
+    std::unordered_map<uint32_t, size_t> mSlotByKey;
+    std::vector<Slot> mSlots;
+    size_t mClockHand = 0;
+};
+
+MaskCacheShard sMaskCacheShards[kNumMaskCacheShards];
+
+MaskCacheShard& GetShard(const NumberWord& guess)
+{
+    return sMaskCacheShards[guess.mIndex % kNumMaskCacheShards];
+}
+
+size_t PopCount(const uint64_t block)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<size_t>(__popcnt64(block));
+#elif defined(__GNUC__)
+    return static_cast<size_t>(__builtin_popcountll(block));
+#else
+    uint64_t count = block - ((block >> 1) & 0x5555555555555555ull);
+    count = (count & 0x3333333333333333ull) + ((count >> 2) & 0x3333333333333333ull);
+    count = (count + (count >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return static_cast<size_t>((count * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+size_t CountTrailingZeros(const uint64_t block)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long index;
+    _BitScanForward64(&index, block);
+    return static_cast<size_t>(index);
+#elif defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(block));
+#else
+    return PopCount((block & (0 - block)) - 1);
+#endif
+}
+
+uint32_t GetMaskKey(const NumberWord& guess, const MatchPattern pattern)
+{
+    return (static_cast<uint32_t>(guess.mIndex) << 8) | pattern;
+}
+
+} // namespace
+
+PossibilitySet::PossibilitySet(const std::vector<NumberWord>& words)
+{
+    Clear();
+    for (const NumberWord& word : words)
+    {
+        Add(word);
+    }
+}
+
+size_t PossibilitySet::Count() const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < kNumBlocks; ++i)
+    {
+        count += PopCount(mBlocks[i]);
+    }
+    return count;
+}
+
+size_t PossibilitySet::CountIntersection(const PossibilitySet& other) const
+{
+    size_t count = 0;
+    for (size_t i = 0; i < kNumBlocks; ++i)
+    {
+        count += PopCount(mBlocks[i] & other.mBlocks[i]);
+    }
+    return count;
+}
+
+void PossibilitySet::IntersectWith(const PossibilitySet& other)
+{
+    for (size_t i = 0; i < kNumBlocks; ++i)
+    {
+        mBlocks[i] &= other.mBlocks[i];
+    }
+}
+
+void PossibilitySet::KeepOnlyMatching(const NumberWord& guess, const MatchPattern pattern)
+{
+    MaskCacheShard& shard = GetShard(guess);
+    const uint32_t key = GetMaskKey(guess, pattern);
+    std::shared_ptr<const PossibilitySet> mask = shard.Find(key);
+    if (!mask)
+    {
+        MatchPattern dictionaryPatterns[kNumWords];
+        NumberWord::GetTestResultsForWholeDictionary(guess, dictionaryPatterns);
+        std::shared_ptr<PossibilitySet> newMask = std::make_shared<PossibilitySet>();
+        for (size_t i = 0; i < kNumWords; ++i)
+        {
+            if (dictionaryPatterns[i] == pattern)
+            {
+                newMask->Add(NumberWord(0u, static_cast<uint16_t>(i)));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        mask = shard.InsertLocked(key, std::move(newMask));
+    }
+    IntersectWith(*mask);
+}
+
+void PossibilitySet::KeepOnlyMatchingByLookup(const NumberWord& guess, const MatchPattern pattern)
+{
+    for (size_t i = 0; i < kNumBlocks; ++i)
+    {
+        uint64_t remaining = mBlocks[i];
+        while (remaining != 0)
+        {
+            const size_t bit = CountTrailingZeros(remaining);
+            remaining &= remaining - 1;
+            const NumberWord word = NumberWord::GetDictionaryWord(static_cast<uint16_t>((i * kBitsPerBlock) + bit));
+            if (word.GetTestResults(guess) != pattern)
+            {
+                mBlocks[i] &= ~(1ull << bit);
+            }
+        }
+    }
+}
+
+void PossibilitySet::GetBucketSizes(const NumberWord& guess, uint16_t outBucketSizes[kMatchPatternHistogramSize]) const
+{
+    memset(outBucketSizes, 0, kMatchPatternHistogramSize * sizeof(uint16_t));
+
+    MaskCacheShard& shard = GetShard(guess);
+    std::shared_ptr<const PossibilitySet> masks[kNumMatchPatterns];
+    bool hasMissingMasks = false;
+    {
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        for (size_t pattern = 0; pattern < kNumMatchPatterns; ++pattern)
+        {
+            masks[pattern] = shard.FindLocked(GetMaskKey(guess, static_cast<MatchPattern>(pattern)));
+            hasMissingMasks = hasMissingMasks || !masks[pattern];
+        }
+    }
+
+    // Any missing masks of this guess are all filled in with one pass over the dictionary
+    if (hasMissingMasks)
+    {
+        std::shared_ptr<PossibilitySet> newMasks[kNumMatchPatterns];
+        for (size_t pattern = 0; pattern < kNumMatchPatterns; ++pattern)
+        {
+            if (!masks[pattern])
+            {
+                newMasks[pattern] = std::make_shared<PossibilitySet>();
+            }
+        }
+
+        MatchPattern dictionaryPatterns[kNumWords];
+        NumberWord::GetTestResultsForWholeDictionary(guess, dictionaryPatterns);
+        for (size_t i = 0; i < kNumWords; ++i)
+        {
+            if (newMasks[dictionaryPatterns[i]])
+            {
+                newMasks[dictionaryPatterns[i]]->Add(NumberWord(0u, static_cast<uint16_t>(i)));
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(shard.mMutex);
+        for (size_t pattern = 0; pattern < kNumMatchPatterns; ++pattern)
+        {
+            if (newMasks[pattern])
+            {
+                masks[pattern] = shard.InsertLocked(GetMaskKey(guess, static_cast<MatchPattern>(pattern)), std::move(newMasks[pattern]));
+            }
+        }
+    }
+
+    for (size_t pattern = 0; pattern < kNumMatchPatterns; ++pattern)
+    {
+        outBucketSizes[pattern] = static_cast<uint16_t>(CountIntersection(*masks[pattern]));
+    }
+}
+
+void PossibilitySet::FilterWords(std::vector<NumberWord>& words) const
+{
+    words.erase(std::remove_if(words.begin(), words.end(), [this](const NumberWord& word) { return !Contains(word); }), words.end());
+}
+
+size_t PossibilitySet::GetNumCachedMasks()
+{
+    size_t numMasks = 0;
+    for (MaskCacheShard& shard : sMaskCacheShards)
+    {
+        numMasks += shard.GetNumMasks();
+    }
+    return numMasks;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+
+// Set of dictionary words as one bit per kWordList index. Narrowing by a (guess, pattern) result is a single AND
+// against a mask that is built the first time that pair is seen and then kept while it stays in use, so repeated
+// games down the same branch (every target of a comprehensive test shares the opening guesses) never recompute a
+// pattern.
+class PossibilitySet
+{
+public:
+    static const size_t kBitsPerBlock = 64;
+    static const size_t kNumBlocks = (kNumWords + kBitsPerBlock - 1) / kBitsPerBlock;
+
+    PossibilitySet() { Clear(); }
+    explicit PossibilitySet(const std::vector<NumberWord>& words);
+
+    void Clear() { memset(mBlocks, 0, sizeof(mBlocks)); }
+    void Add(const NumberWord& word)
+    {
+        assert(word.mIndex < kNumWords);
+        mBlocks[word.mIndex / kBitsPerBlock] |= (1ull << (word.mIndex % kBitsPerBlock));
+    }
+    bool Contains(const NumberWord& word) const
+    {
+        assert(word.mIndex < kNumWords);
+        return (mBlocks[word.mIndex / kBitsPerBlock] & (1ull << (word.mIndex % kBitsPerBlock))) != 0;
+    }
+
+    size_t Count() const;
+    size_t CountIntersection(const PossibilitySet& other) const;
+    void IntersectWith(const PossibilitySet& other);
+
+    // Keeps only the words that give pattern when guess is played against them
+    void KeepOnlyMatching(const NumberWord& guess, MatchPattern pattern);
+    // The same, looking up the pattern of each word still in the set instead of going through the shared mask cache.
+    // Takes no lock, and costs less than building a mask once the set is down to a few hundred words.
+    void KeepOnlyMatchingByLookup(const NumberWord& guess, MatchPattern pattern);
+
+    // Number of words in this set per pattern against guess, from popcounts of the cached masks
+    void GetBucketSizes(const NumberWord& guess, uint16_t outBucketSizes[kMatchPatternHistogramSize]) const;
+
+    // Removes every entry of words that isn't in this set, keeping the order of the rest
+    void FilterWords(std::vector<NumberWord>& words) const;
+
+    static size_t GetNumCachedMasks();
+
+private:
+    uint64_t mBlocks[kNumBlocks];
+};
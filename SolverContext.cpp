@@ -0,0 +1,109 @@
+#include "SolverContext.h"
+
+NumWordB::SolverConfiguration::SolverConfiguration()
+    : mStepStrategies
+    {
+        StepStrategy::kSpecialWord2,
+        StepStrategy::kOptimalPatternMatch,
+        StepStrategy::kOptimalPatternMatch,
+        StepStrategy::kOptimalPatternMatch,
+        StepStrategy::kOptimalPatternMatch,
+        StepStrategy::kTakeFirstEntry
+    }
+    , mSpecialWord1(NumberWord::LookupNumberWord("stowp"))
+    , mSpecialWord2(NumberWord::LookupNumberWord("trace"))
+{
+}
+
+NumWordB::SolverContext::Source::Source(const std::vector<NumberWord>& words)
+    : mWords(words)
+    , mSet(words)
+{
+    mHash = 14695981039346656037ull;
+    for (const NumberWord& word : words)
+    {
+        mHash ^= word.mIndex;
+        mHash *= 1099511628211ull;
+    }
+}
+
+NumWordB::SolverContext::SolverContext(const SolverConfiguration& configuration, const std::vector<NumberWord>& source, const Dictionary& dictionary)
+    : mConfiguration(configuration)
+    , mSource(std::make_shared<const Source>(source))
+    , mDictionary(&dictionary)
+    , mConfigurationHash(GetConfigurationHash(configuration, source))
+{
+    FindFirstGuess();
+}
+
+NumWordB::SolverContext::SolverContext(const SolverConfiguration& configuration, const SolverContext& sourceOf)
+    : mConfiguration(configuration)
+    , mSource(sourceOf.mSource)
+    , mDictionary(sourceOf.mDictionary)
+    , mConfigurationHash(GetConfigurationHash(configuration, sourceOf.GetSource()))
+{
+    FindFirstGuess();
+}
+
+void NumWordB::SolverContext::FindFirstGuess()
+{
+    const StepStrategy firstStrategy = mConfiguration.GetStepStrategy(mConfiguration.mStartingStep);
+    if (firstStrategy == StepStrategy::kSpecialWord1)
+    {
+        mFirstGuess = mConfiguration.mSpecialWord1;
+    }
+    else if (firstStrategy == StepStrategy::kSpecialWord2)
+    {
+        mFirstGuess = mConfiguration.mSpecialWord2;
+    }
+}
+
+uint64_t NumWordB::SolverContext::GetConfigurationHash(const SolverConfiguration& configuration, const std::vector<NumberWord>& source)
+{
+    uint64_t hash = 14695981039346656037ull;
+    const auto addToHash = [&hash](const uint64_t value)
+    {
+        for (size_t i = 0; i < sizeof(value); ++i)
+        {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 1099511628211ull;
+        }
+    };
+
+    for (size_t i = 0; i < kMaxSteps; ++i)
+    {
+        addToHash(static_cast<uint64_t>(configuration.mStepStrategies[i]));
+    }
+    addToHash(static_cast<uint64_t>(configuration.mStrategyPostMax));
+    addToHash(configuration.mStartingStep);
+    // The input word is the game's, not the configuration's. This is what it hashed as before any game, and trees,
+    // books and journals compiled with it in the hash still match.
+    addToHash(kInvalidNumberWord.mValue);
+    addToHash(configuration.mSpecialWord1.mValue);
+    addToHash(configuration.mSpecialWord2.mValue);
+    addToHash(source.size());
+    for (const NumberWord& possibility : source)
+    {
+        addToHash((static_cast<uint64_t>(possibility.mIndex) << 32) | possibility.mValue);
+    }
+    return hash;
+}
+
+const PossibilitySet* NumWordB::SolverContext::FindFirstGuessSet(const NumberWord& guess, const MatchPattern pattern) const
+{
+    if ((mFirstGuess == kInvalidNumberWord) || (guess != mFirstGuess))
+    {
+        return nullptr;
+    }
+
+    // Filled once, by whichever game sharing the context gets here first, every other game only reads them
+    std::call_once(mFirstGuessSetsFilled, [this]()
+    {
+        mFirstGuessSets.resize(kNumMatchPatterns);
+        for (const NumberWord& word : mSource->mWords)
+        {
+            mFirstGuessSets[word.GetTestResults(mFirstGuess)].Add(word);
+        }
+    });
+    return &mFirstGuessSets[pattern];
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "PossibilitySet.h"
+#include "Dictionary.h"
+
+namespace NumWordB
+{
+const size_t kMaxSteps = 6;
+
+enum class StepStrategy : uint8_t
+{
+    kOptimalPatternMatch,
+    kOptimalPatternMatchWithAlternatives,
+    kSpecialWord1, // stowp
+    kSpecialWord2, // trace
+    kUseInputWord,
+    kTakeFirstEntry,
+    kOpeningBook, // The book's guess while play follows it, FindOptimalPatternMatch's otherwise
+    kMaxEntropy, // Most information gained, by the fixed-point n*log2(n) of each match set
+    kMinExpectedSize // Fewest possibilities expected to remain
+};
+
+// Which strategy each step takes, and the words the special word strategies guess
+struct SolverConfiguration
+{
+    SolverConfiguration();
+
+    // currentStep counts the guesses made before this one
+    StepStrategy GetStepStrategy(size_t currentStep) const { return (currentStep < kMaxSteps) ? mStepStrategies[currentStep] : mStrategyPostMax; }
+
+    StepStrategy mStepStrategies[kMaxSteps];
+    StepStrategy mStrategyPostMax = StepStrategy::kOptimalPatternMatch;
+    size_t mStartingStep = 0;
+    NumberWord mSpecialWord1;
+    NumberWord mSpecialWord2;
+};
+
+// Everything a strategy's guesses depend on besides the game played so far: its configuration, the possibilities it
+// solves over, with what is worked out from them up front, and the dictionary whose test words it guesses from.
+// Nothing in it changes once it is made, so strategies on any number of threads can share one, each keeping just its
+// own game and scratch. The source is copied in, so the caller's vector can change or go away afterwards. The
+// dictionary is only referenced, and has to outlive the context.
+class SolverContext
+{
+public:
+    SolverContext(const SolverConfiguration& configuration, const std::vector<NumberWord>& source, const Dictionary& dictionary);
+    // The same source and dictionary as sourceOf, the source shared rather than copied and hashed again
+    SolverContext(const SolverConfiguration& configuration, const SolverContext& sourceOf);
+
+    SolverContext(const SolverContext&) = delete;
+    SolverContext& operator=(const SolverContext&) = delete;
+
+    // FNV-1a over everything that decides which guess is made, so a tree or book compiled under one configuration is
+    // never followed under another
+    static uint64_t GetConfigurationHash(const SolverConfiguration& configuration, const std::vector<NumberWord>& source);
+
+    const SolverConfiguration& GetConfiguration() const { return mConfiguration; }
+    const Dictionary& GetDictionary() const { return *mDictionary; }
+    // Whichever of the dictionary's word sets is in use, at the time of asking
+    const std::vector<NumberWord>& GetTestWords() const { return mDictionary->GetAllWords(); }
+    const std::vector<NumberWord>& GetSource() const { return mSource->mWords; }
+    const PossibilitySet& GetSourceSet() const { return mSource->mSet; }
+    // Over the source in order, since the first entry strategy and tie-breaks depend on that order too
+    uint64_t GetSourceHash() const { return mSource->mHash; }
+    // Whether source holds the same words in the same order, wherever it is
+    bool HasSource(const std::vector<NumberWord>& source) const { return source == mSource->mWords; }
+    uint64_t GetConfigurationHash() const { return mConfigurationHash; }
+
+    // The source narrowed to what gives pattern against the guess the first step always makes, the widest narrowing
+    // of every game. nullptr if guess isn't that one, or the configuration doesn't fix the first guess. Worked out on
+    // the first call, so contexts that are configured and thrown away before any game cost no more than their hash.
+    const PossibilitySet* FindFirstGuessSet(const NumberWord& guess, MatchPattern pattern) const;
+
+private:
+    struct Source
+    {
+        explicit Source(const std::vector<NumberWord>& words);
+
+        std::vector<NumberWord> mWords;
+        PossibilitySet mSet;
+        uint64_t mHash = 0;
+    };
+
+    void FindFirstGuess();
+
+    SolverConfiguration mConfiguration;
+    std::shared_ptr<const Source> mSource;
+    const Dictionary* mDictionary;
+    uint64_t mConfigurationHash = 0;
+
+    NumberWord mFirstGuess = kInvalidNumberWord;
+    mutable std::once_flag mFirstGuessSetsFilled;
+    mutable std::vector<PossibilitySet> mFirstGuessSets; // By pattern
+};
+} // namespace NumWordB
@@ -0,0 +1,20 @@
+#include "StepArena.h"
+
+StepArena::StepArena(const size_t numSteps)
+{
+    mSteps.reserve(numSteps);
+    for (size_t i = 0; i < numSteps; ++i)
+    {
+        mSteps.emplace_back(kNumWords);
+    }
+}
+
+uint16_t* StepArena::GetStep(const size_t step)
+{
+    // Growing the outer vector moves the inner ones, which keeps their storage where it was
+    while (mSteps.size() <= step)
+    {
+        mSteps.emplace_back(kNumWords);
+    }
+    return mSteps[step].data();
+}
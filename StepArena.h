@@ -0,0 +1,27 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+
+// Word-index buffers for every step of a game, allocated up front and handed out again to every game after, so
+// narrowing the possibilities step by step never goes through the heap. Each buffer holds kWordList indices and has
+// room for the whole dictionary, so a step can always write its possibilities next to the previous step's.
+class StepArena
+{
+public:
+    static const size_t kDefaultNumSteps = 16;
+
+    explicit StepArena(size_t numSteps = kDefaultNumSteps);
+
+    StepArena(const StepArena&) = delete;
+    StepArena& operator=(const StepArena&) = delete;
+
+    // Steps past the preallocated ones are added on first use, without moving the buffers already handed out
+    uint16_t* GetStep(size_t step);
+
+    // Rebuilt for each step's possibilities, keeping its storage from the steps before
+    MatchPatternLookup& GetLookup() { return mLookup; }
+
+private:
+    std::vector<std::vector<uint16_t>> mSteps;
+    MatchPatternLookup mLookup;
+};
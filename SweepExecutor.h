@@ -0,0 +1,172 @@
+#pragma once
+#include "stdafx.h"
+#include "NumWords.h"
+#include "StepArena.h"
+#include "ThreadPool.h"
+
+namespace NumWordA
+{
+const uint32_t kMaxSweepSteps = 12;
+
+// One target played out from one source word. mSteps counts the guesses made before the one that found the target,
+// kMaxSweepSteps if none did, and mGuessIndices holds the kWordList index of every guess, the source word first.
+struct SweepGame
+{
+    uint32_t mSteps = 0;
+    uint32_t mNumGuesses = 0;
+    uint16_t mGuessIndices[kMaxSweepSteps];
+};
+
+// Writes the kWordList indices of the possibilities still valid into outNewPossibilities and returns their count.
+// Narrowing the whole dictionary by a source word goes through a PatternPartition instead.
+inline size_t PairDownSetForWordFromEntryWord(MatchPattern sourceMatch, const NumberWord& entryWord, const uint16_t* const sourcePossibilities, const size_t numSourcePossibilities, uint16_t* const outNewPossibilities)
+{
+    size_t numNewPossibilities = 0;
+    for (size_t i = 0; i < numSourcePossibilities; ++i)
+    {
+        if (NumberWord::GetDictionaryWord(sourcePossibilities[i]).IsValidWith(entryWord, sourceMatch))
+        {
+            outNewPossibilities[numNewPossibilities++] = sourcePossibilities[i];
+        }
+    }
+    return numNewPossibilities;
+}
+
+struct NoStepObserver
+{
+    void operator()(uint32_t, const NumberWord&, MatchPattern, const uint16_t*, size_t) const {}
+};
+
+// Guesses the word sourcePartition split the dictionary by, then whatever the policy picks from what is left, until
+// targetWord comes up or the policy's GetMaxSteps() runs out. The first step's possibilities are just the target's
+// bucket, so a partition made once per source word saves every game its pass over the whole dictionary. The
+// StepPolicy provides:
+//   uint32_t GetMaxSteps() const;
+//   NumberWord GetGuess(uint32_t steps, const uint16_t* possibilities, size_t numPossibilities, MatchPatternLookup& lookup) const;
+// observer(steps, guess, results, possibilities, numPossibilities) sees every guess that didn't hit, along with the
+// possibilities it left.
+template <typename StepPolicy, typename StepObserver>
+SweepGame PlaySweepGame(const PatternPartition& sourcePartition, const NumberWord& targetWord, const StepPolicy& policy, StepArena& arena, StepObserver& observer)
+{
+    const NumberWord& sourceWord = sourcePartition.GetGuess();
+    SweepGame game;
+    game.mGuessIndices[game.mNumGuesses++] = sourceWord.mIndex;
+    if (targetWord == sourceWord)
+    {
+        return game;
+    }
+
+    MatchPattern results = targetWord.GetTestResults(sourceWord);
+    const uint16_t* possibilities = sourcePartition.GetBucket(results);
+    size_t numPossibilities = sourcePartition.GetBucketSize(results);
+    observer(game.mSteps, sourceWord, results, possibilities, numPossibilities);
+
+    for (game.mSteps = 1; game.mSteps < policy.GetMaxSteps(); ++game.mSteps)
+    {
+        const NumberWord guess = policy.GetGuess(game.mSteps, possibilities, numPossibilities, arena.GetLookup());
+        game.mGuessIndices[game.mNumGuesses++] = guess.mIndex;
+        if (guess == targetWord)
+        {
+            break;
+        }
+
+        uint16_t* const newPossibilities = arena.GetStep(game.mSteps);
+        results = targetWord.GetTestResults(guess);
+        numPossibilities = PairDownSetForWordFromEntryWord(results, guess, possibilities, numPossibilities, newPossibilities);
+        observer(game.mSteps, guess, results, newPossibilities, numPossibilities);
+        possibilities = newPossibilities;
+    }
+    return game;
+}
+
+template <typename StepPolicy>
+SweepGame PlaySweepGame(const PatternPartition& sourcePartition, const NumberWord& targetWord, const StepPolicy& policy, StepArena& arena)
+{
+    NoStepObserver observer;
+    return PlaySweepGame(sourcePartition, targetWord, policy, arena, observer);
+}
+
+// Plays every target from every source word on the thread pool, each worker with its own StepArena. Every game starts
+// from possibilityWords, which the targets have to be among, narrowed by its source word. The ResultSink
+// provides:
+//   bool OnGame(size_t sourceIndex, size_t targetIndex, const SweepGame& game);
+//   void OnSourceDone(size_t sourceIndex);
+// OnGame gets a source's games one at a time in target order, and returning false skips that source's remaining
+// targets. Different sources may be in OnGame at once. OnSourceDone is called one at a time, in source order.
+// With enough sources to go around, each worker takes whole sources. Otherwise the sources go one after another,
+// their targets spread over the workers.
+template <typename StepPolicy, typename ResultSink>
+void RunSweep(const std::vector<NumberWord>& sourceWords, const std::vector<NumberWord>& possibilityWords, const std::vector<NumberWord>& targetWords, const StepPolicy& policy, ResultSink& sink)
+{
+    ThreadPool& threadPool = ThreadPool::Get();
+
+    // Only made for the workers that end up running, which is just worker 0 when called from inside other pool work
+    std::vector<std::unique_ptr<StepArena>> arenas(threadPool.GetNumWorkers());
+    auto getArena = [&arenas](size_t workerIndex) -> StepArena&
+    {
+        if (!arenas[workerIndex])
+        {
+            arenas[workerIndex].reset(new StepArena());
+        }
+        return *arenas[workerIndex];
+    };
+
+    std::mutex deliveryMutex;
+    if (sourceWords.size() >= threadPool.GetNumWorkers())
+    {
+        std::vector<uint8_t> isSourceDone(sourceWords.size(), 0);
+        size_t nextToDeliver = 0;
+        threadPool.RunWorkStealing(sourceWords.size(), [&](size_t workerIndex, size_t source)
+        {
+            // Games only ever write from step 1 on, step 0 holds the source's partition
+            StepArena& arena = getArena(workerIndex);
+            PatternPartition sourcePartition;
+            sourcePartition.Assign(sourceWords[source], possibilityWords, arena.GetStep(0));
+            for (size_t target = 0; target < targetWords.size(); ++target)
+            {
+                if (!sink.OnGame(source, target, PlaySweepGame(sourcePartition, targetWords[target], policy, arena)))
+                {
+                    break;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(deliveryMutex);
+            isSourceDone[source] = 1;
+            for (; (nextToDeliver < sourceWords.size()) && isSourceDone[nextToDeliver]; ++nextToDeliver)
+            {
+                sink.OnSourceDone(nextToDeliver);
+            }
+            return true;
+        });
+        return;
+    }
+
+    std::vector<SweepGame> games(targetWords.size());
+    std::vector<uint8_t> isPlayed(targetWords.size());
+    std::vector<uint16_t> sourceBucketed(possibilityWords.size());
+    PatternPartition sourcePartition;
+    for (size_t source = 0; source < sourceWords.size(); ++source)
+    {
+        sourcePartition.Assign(sourceWords[source], possibilityWords, sourceBucketed.data());
+
+        // Games finish in any order and wait here until every target ahead of theirs is delivered
+        std::fill(isPlayed.begin(), isPlayed.end(), static_cast<uint8_t>(0));
+        size_t nextToDeliver = 0;
+        bool isSourceStopped = false;
+        threadPool.RunWorkStealing(targetWords.size(), [&](size_t workerIndex, size_t target)
+        {
+            const SweepGame game = PlaySweepGame(sourcePartition, targetWords[target], policy, getArena(workerIndex));
+
+            std::lock_guard<std::mutex> lock(deliveryMutex);
+            games[target] = game;
+            isPlayed[target] = 1;
+            for (; !isSourceStopped && (nextToDeliver < targetWords.size()) && isPlayed[nextToDeliver]; ++nextToDeliver)
+            {
+                isSourceStopped = !sink.OnGame(source, nextToDeliver, games[nextToDeliver]);
+            }
+            return !isSourceStopped;
+        });
+        sink.OnSourceDone(source);
+    }
+}
+} // namespace NumWordA
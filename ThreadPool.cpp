@@ -0,0 +1,176 @@
+#include "ThreadPool.h"
+
+namespace
+{
+thread_local bool sIsRunningPoolWork = false;
+}
+
+ThreadPool& ThreadPool::Get()
+{
+    static ThreadPool sThreadPool(std::max<size_t>(1u, std::thread::hardware_concurrency()));
+    return sThreadPool;
+}
+
+ThreadPool::ThreadPool(const size_t numWorkers)
+{
+    for (size_t i = 1; i < numWorkers; ++i)
+    {
+        mThreads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mWorkReady.notify_all();
+    for (std::thread& thread : mThreads)
+    {
+        thread.join();
+    }
+}
+
+void ThreadPool::RunOnAllWorkers(const std::function<void(size_t)>& work)
+{
+    if (sIsRunningPoolWork)
+    {
+        work(0);
+        return;
+    }
+    if (mThreads.empty())
+    {
+        // Still pool work, so whatever it calls keeps off the other pools
+        sIsRunningPoolWork = true;
+        work(0);
+        sIsRunningPoolWork = false;
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(mRunMutex);
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mWork = &work;
+        mNumBusyWorkers = mThreads.size();
+        ++mGeneration;
+    }
+    mWorkReady.notify_all();
+
+    sIsRunningPoolWork = true;
+    work(0);
+    sIsRunningPoolWork = false;
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mWorkDone.wait(lock, [this]() { return mNumBusyWorkers == 0; });
+    mWork = nullptr;
+}
+
+void ThreadPool::KeepCallingThreadOffPool()
+{
+    sIsRunningPoolWork = true;
+}
+
+void ThreadPool::RunWorkStealing(const size_t numItems, const std::function<bool(size_t, size_t)>& work)
+{
+    struct Share
+    {
+        std::mutex mMutex;
+        size_t mNext = 0;
+        size_t mEnd = 0;
+    };
+
+    const size_t numWorkers = GetNumWorkers();
+    std::unique_ptr<Share[]> shares(new Share[numWorkers]);
+    for (size_t i = 0; i < numWorkers; ++i)
+    {
+        shares[i].mNext = (numItems * i) / numWorkers;
+        shares[i].mEnd = (numItems * (i + 1)) / numWorkers;
+    }
+    std::atomic<bool> isStopping(false);
+
+    // Run from inside other pool work, only worker 0 runs, and it ends up stealing every share in turn
+    RunOnAllWorkers([&shares, &isStopping, &work, numWorkers](size_t workerIndex)
+    {
+        Share& ownShare = shares[workerIndex];
+        while (!isStopping.load(std::memory_order_relaxed))
+        {
+            size_t item = SIZE_MAX;
+            {
+                std::lock_guard<std::mutex> lock(ownShare.mMutex);
+                if (ownShare.mNext < ownShare.mEnd)
+                {
+                    item = ownShare.mNext++;
+                }
+            }
+
+            if (item != SIZE_MAX)
+            {
+                if (!work(workerIndex, item))
+                {
+                    isStopping = true;
+                }
+                continue;
+            }
+
+            size_t victim = SIZE_MAX;
+            size_t mostItemsLeft = 0;
+            for (size_t i = 0; i < numWorkers; ++i)
+            {
+                std::lock_guard<std::mutex> lock(shares[i].mMutex);
+                if ((i != workerIndex) && ((shares[i].mEnd - shares[i].mNext) > mostItemsLeft))
+                {
+                    victim = i;
+                    mostItemsLeft = shares[i].mEnd - shares[i].mNext;
+                }
+            }
+            if (victim == SIZE_MAX)
+            {
+                // Whatever is still being stolen gets run by the thief
+                return;
+            }
+
+            // The victim may have drained meanwhile, then the next pass just looks again
+            size_t stolenFirst = 0;
+            size_t stolenEnd = 0;
+            {
+                std::lock_guard<std::mutex> lock(shares[victim].mMutex);
+                const size_t itemsLeft = shares[victim].mEnd - shares[victim].mNext;
+                stolenEnd = shares[victim].mEnd;
+                stolenFirst = stolenEnd - ((itemsLeft + 1) / 2);
+                shares[victim].mEnd = stolenFirst;
+            }
+            std::lock_guard<std::mutex> lock(ownShare.mMutex);
+            ownShare.mNext = stolenFirst;
+            ownShare.mEnd = stolenEnd;
+        }
+    });
+}
+
+void ThreadPool::WorkerLoop(const size_t workerIndex)
+{
+    sIsRunningPoolWork = true;
+    uint64_t lastGeneration = 0;
+    while (true)
+    {
+        const std::function<void(size_t)>* work = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkReady.wait(lock, [this, lastGeneration]() { return mIsStopping || (mGeneration != lastGeneration); });
+            if (mIsStopping)
+            {
+                return;
+            }
+            lastGeneration = mGeneration;
+            work = mWork;
+        }
+
+        (*work)(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mNumBusyWorkers;
+        }
+        mWorkDone.notify_one();
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "stdafx.h"
+
+// Worker threads kept alive for the whole run, so the many short parallel loops of a comprehensive test don't pay
+// for creating threads every time. Work is expected to pull its items from a shared counter, so it completes no
+// matter how many workers end up running it. Callers of one pool take turns, so work meant to run beside what is on
+// the shared pool gets a pool of its own. Pool calls made from inside work on any pool run on that work's thread.
+class ThreadPool
+{
+public:
+    // The pool everything shares
+    static ThreadPool& Get();
+
+    // numWorkers includes the calling thread of each call
+    explicit ThreadPool(size_t numWorkers);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Includes the calling thread
+    size_t GetNumWorkers() const { return mThreads.size() + 1; }
+
+    // Runs work(workerIndex) on every worker, the calling thread as worker 0, and returns once all are done.
+    // Called from inside work it just runs work(0) on the current thread.
+    void RunOnAllWorkers(const std::function<void(size_t)>& work);
+
+    // From now on, every call from the calling thread runs its work right there, alone, as if from inside other work.
+    // For a background thread whose work must never keep the pool from the other callers.
+    static void KeepCallingThreadOffPool();
+
+    // Runs work(workerIndex, item) for each item below numItems. Every worker starts on its own contiguous share of
+    // the items, and once that runs out takes the back half of whichever share has the most left, so uneven items
+    // still keep every worker busy. Once any call returns false, items not yet started are skipped.
+    void RunWorkStealing(size_t numItems, const std::function<bool(size_t, size_t)>& work);
+
+private:
+    void WorkerLoop(size_t workerIndex);
+
+    std::vector<std::thread> mThreads;
+    std::mutex mRunMutex;
+    std::mutex mMutex;
+    std::condition_variable mWorkReady;
+    std::condition_variable mWorkDone;
+    const std::function<void(size_t)>* mWork = nullptr;
+    uint64_t mGeneration = 0;
+    size_t mNumBusyWorkers = 0;
+    bool mIsStopping = false;
+};
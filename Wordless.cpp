@@ -8,12 +8,23 @@
 
 #include "CommandNumWordA.h"
 #include "CommandNumWordB.h"
+#include "CommandBenchmark.h"
 
-int main()
+int main(int argc, char* argv[])
 {
     putchar('\n');
 
-    NumberWord::Initialize();
+    // --answers-only keeps just the answer words as match pattern matrix columns, for when only they are ever targets
+    MatchPatternMatrixMode matrixMode = MatchPatternMatrixMode::kAllWords;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--answers-only") == 0)
+        {
+            matrixMode = MatchPatternMatrixMode::kAnswersOnly;
+        }
+    }
+
+    NumberWord::Initialize(matrixMode);
 
     ConsoleMenu mainMenu("Main Menu");
 
@@ -45,11 +56,24 @@ int main()
     menuNumWordBExploration.AddCommand("grrrrr", "Try to find any optimal word for double 2049", NumWordB::COMMAND_IsThereAnyOptimalWordForDouble2049);
     menuNumWordBExploration.AddCommand("vfc", "Display all 'very far removed' letters (no three pair connections)", NumWordB::COMMAND_DisplayFarRemovedLetterCombinations);
     menuNumWordBExploration.AddCommand("fsw", "Find fewest steps word;dStarting index;dUntil index", NumWordB::COMMAND_FindFewestStepsOpeningWord);
+    menuNumWordBExploration.AddCommand("fswr", "Rank opening words journaled by fsw", NumWordB::COMMAND_RankJournaledOpeningWords);
+    menuNumWordBExploration.AddCommand("exact", "Find the fewest steps any tree takes from an opener;tOpening word;dTest words tried per set, 0 for all", NumWordB::COMMAND_FindExactFewestSteps);
+
+    ConsoleMenu menuBenchmarks("Benchmarks", mainMenu);
+    menuBenchmarks.AddCommand("ml", "Match pattern matrix layouts", Benchmark::COMMAND_MatchPatternLayouts);
+    menuBenchmarks.AddCommand("pf", "Possibility filtering", Benchmark::COMMAND_PossibilityFiltering);
+    menuBenchmarks.AddCommand("sa", "Heap allocations while solving", Benchmark::COMMAND_StepAllocations);
+    menuBenchmarks.AddCommand("ss", "Scoring strategies", Benchmark::COMMAND_ScoringStrategies);
 
     mainMenu.AddSubmenu("nwa", menuNumWordAExploration);
     mainMenu.AddSubmenu("nwb", menuNumWordBExploration);
+    mainMenu.AddSubmenu("bench", menuBenchmarks);
     mainMenu.AddCommand("wordle", "Play Wordle Solver", NumWordB::COMMAND_PlayWordle);
+    mainMenu.AddCommand("tword", "Play Wordle Solver, each guess within a time limit;dMilliseconds", NumWordB::COMMAND_PlayWordleWithTimeBudget);
     mainMenu.AddCommand("quordle", "Play Quordle Solver", NumWordB::COMMAND_PlayQuordle);
+    mainMenu.AddCommand("ob", "Compile opening book for Wordle/Quordle;tOpening word;dTest words played out per set, 0 for all", NumWordB::COMMAND_CompileOpeningBook);
+    mainMenu.AddCommand("dt", "Compile decision tree for Wordle/Quordle", NumWordB::COMMAND_CompileDecisionTree);
+    mainMenu.AddCommand("mp", "Rebuild match pattern file", NumberWord::RebuildMatchPatterns);
 
     mainMenu.ResetMenu();
 